@@ -2,15 +2,28 @@
 #ifndef CHAPTER_6_BACK_EULER_METHOD_H
 #define CHAPTER_6_BACK_EULER_METHOD_H
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <utility>
 #include <vector>
 
+#include "IterationMatrix.h"
+#include "LinearAlgebra.h"
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "SolverStats.h"
+#include "Trajectory.h"
+
 
 using func1 = std::function<double(double t, double y)>;
 
 enum EulerStatus {
     EULER_STATUS_OK = 0,
-    EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE = 1
+    EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE = 1,
+    EULER_STATUS_ERROR_SINGULAR_JACOBIAN = 2,
+    EULER_STATUS_ERROR_INVALID_JACOBIAN_PATTERN = 3
 };
 
 
@@ -23,6 +36,10 @@ enum EulerStatus {
  *
  *      y(t0) = y0
  *
+ * Each step is solved with simplified Newton's method, which keeps `fy` from earlier iterations and steps until
+ * convergence slows, starting from a prediction from the previous step. A step whose iteration fails to converge is
+ * retried as two half steps, up to `BACKWARD_EULER_MAX_HALVINGS` times.
+ *
  * @param f the function `f`. The first argument corresponds to t and second to y.
  * @param fy partial derivative of `f` with respect to `y`. The first argument corresponds to t and second to y.
  * @param t vector to store time index (must have correct size).
@@ -31,10 +48,506 @@ enum EulerStatus {
  * @param t0 initial time.
  * @param t1 final time.
  * @param tolerance the tolerance for Newton's method.
- * @param maxIterations the maximum number of iterations for Newton's method.
- * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param stats if not null, the statistics to add the evaluations, steps and Newton iterations of the run to.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps.
  */
 EulerStatus backwardEulerMethod(const func1 &f, const func1 &fy, std::vector<double> &t, std::vector<double> &y,
-                                 double y0, double t0, double t1, double tolerance = 1e-6, int maxIterations = 10);
+                                 double y0, double t0, double t1, double tolerance = 1e-6, int maxIterations = 10,
+                                 SolverStats *stats = nullptr);
+
+
+/**
+ * Uses the backward Euler method to solve an ODE of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition y(t0) = y0, passing the states to `observer` instead of storing them.
+ *
+ * @param f the function `f`. The first argument corresponds to t and second to y.
+ * @param fy partial derivative of `f` with respect to `y`. The first argument corresponds to t and second to y.
+ * @param y0 initial condition.
+ * @param t0 initial time.
+ * @param t1 final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, &y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param tolerance the tolerance for Newton's method.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param stats if not null, the statistics to add the evaluations, steps and Newton iterations of the run to.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps.
+ */
+EulerStatus backwardEulerMethod(const func1 &f, const func1 &fy, double y0, double t0, double t1, int n,
+                                const observern &observer, int every = 1, double tolerance = 1e-6,
+                                int maxIterations = 10, SolverStats *stats = nullptr);
+
+
+/**
+ * The number of times `backwardEulerMethod` halves a step whose Newton iteration fails before giving up, so a step is
+ * split into at most 2^10 substeps.
+ */
+constexpr int BACKWARD_EULER_MAX_HALVINGS = 10;
+
+/**
+ * The contraction rate of the Newton updates, |delta[k]| / |delta[k - 1]|, above which `backwardEulerMethod`
+ * re-evaluates a Jacobian kept from an earlier iteration or step.
+ */
+constexpr double BACKWARD_EULER_SLOW_CONVERGENCE = 0.1;
+
+
+/**
+ * The outcome of the Newton solve for a single backward Euler step.
+ */
+struct NewtonStepReport {
+    // The number of Newton iterations taken, over all attempts and substeps.
+    int iterations = 0;
+
+    // The max-norm of the last Newton update.
+    double delta = 0;
+
+    // The number of times the step was halved because Newton's method failed, so it took up to 2^halvings substeps.
+    int halvings = 0;
+
+    // STATUS_OK if the iteration converged.
+    EulerStatus status = EULER_STATUS_OK;
+};
+
+
+/**
+ * Scratch storage for the system form of `backwardEulerMethod`: the Newton residual, the factored iteration matrix,
+ * the current and next state for the observer variant, and what is kept from one step to the next: the Jacobian, the
+ * step size the iteration matrix was factored for and the slope at the end of the last step. Sized once per
+ * integration and reusable across integrations.
+ *
+ * `Matrix` decides how the Jacobian is stored and the iteration matrix factored: densely by default, or as
+ * `BandedIterationMatrix` or `SparseIterationMatrix` for large systems such as discretized PDEs, whose storage and
+ * work then grow about linearly with the dimension. `fy` must fill the Jacobian in the layout `Matrix` documents:
+ *
+ *      NewtonWorkspace workspace(BandedIterationMatrix(1, 1));
+ *      backwardEulerMethod(f, tridiagonalJacobian, trajectory, y0, t0, t1, 1e-6, 10, nullptr, workspace);
+ */
+template <typename Matrix = DenseIterationMatrix>
+struct NewtonWorkspace {
+    Matrix matrix;
+    std::vector<double> residual;
+    std::vector<double> states;
+    std::vector<double> jacobian;
+    std::vector<double> slope;
+    std::vector<double> substep;
+
+    // Whether `jacobian` holds a Jacobian.
+    bool jacobianValid = false;
+
+    // The step size `matrix` holds the factored I - h J for, or 0 if none.
+    double factoredStep = 0;
+
+    // Whether `slope` holds (z - y) / h of the last step, which is f at its end.
+    bool slopeValid = false;
+
+    NewtonWorkspace() = default;
+
+    /**
+     * @param matrix the iteration matrix, such as a `BandedIterationMatrix` with the bandwidths of the Jacobian.
+     */
+    explicit NewtonWorkspace(Matrix matrix) : matrix(std::move(matrix)) {}
+
+    /**
+     * Size the storage for a system of dimension `m` and forget what was kept from earlier steps.
+     * @return STATUS_OK, or STATUS_ERROR_INVALID_PATTERN if the iteration matrix has a sparsity pattern that is
+     *         invalid or not of dimension `m`.
+     */
+    LinearAlgebraStatus resize(std::size_t m) {
+        auto status = matrix.resize(m);
+        if (status != LINEAR_ALGEBRA_STATUS_OK) return status;
+        residual.resize(m);
+        states.resize(2 * m);
+        jacobian.resize(matrix.jacobianSize());
+        slope.resize(m);
+        substep.resize(m);
+        reset();
+        return LINEAR_ALGEBRA_STATUS_OK;
+    }
+
+    /**
+     * Forget what was kept from earlier steps, such as when the next step is of another system.
+     */
+    void reset() {
+        jacobianValid = false;
+        factoredStep = 0;
+        slopeValid = false;
+    }
+};
+
+
+/**
+ * Makes a single attempt at solving
+ *
+ *      z - y - h f(t + h, z) = 0
+ *
+ * for z with simplified Newton's method: the iteration matrix I - h J is factored once and reused for as long as the
+ * updates shrink by at least `BACKWARD_EULER_SLOW_CONVERGENCE` per iteration, across iterations and across steps.
+ * Only when they do not is J re-evaluated, at the current iterate, or at the previous one if the update diverged. The
+ * iteration starts from a linearly implicit Euler prediction from the slope at the end of the last step. An update
+ * that is not finite fails the attempt, so the step is retried with a fresh Jacobian on smaller substeps. See
+ * `backwardEulerStep` for the parameters.
+ */
+template <OdeSystem System, OdeJacobian Jacobian, typename Matrix>
+NewtonStepReport backwardEulerAttempt(System &f, Jacobian &fy, std::size_t m, double t, const double *y, double h,
+                                      double *z, double tolerance, int maxIterations,
+                                      NewtonWorkspace<Matrix> &workspace) {
+    auto residual = workspace.residual.data();
+    auto jacobian = workspace.jacobian.data();
+    auto slope = workspace.slope.data();
+    auto stats = solverStats(f);
+    t += h;
+
+    auto solve = [&] {
+        workspace.matrix.solve(residual);
+    };
+    auto refactor = [&] {
+        // Iteration matrix I - h J.
+        auto factor = [&] { return workspace.matrix.factor(h, jacobian) == LINEAR_ALGEBRA_STATUS_OK; };
+        auto factored = stats ? measureOperation(*stats, stats->linearAlgebra, factor) : factor();
+        workspace.factoredStep = factored ? h : 0;
+        return factored;
+    };
+    // Whether the Jacobian was evaluated at the iterate the next update starts from, so re-evaluating it cannot help.
+    auto current = false;
+    auto evaluateJacobian = [&] {
+        if (stats) {
+            measureJacobian(*stats, fy, t, z, jacobian);
+        }
+        else {
+            fy(t, z, jacobian);
+        }
+        workspace.jacobianValid = true;
+        current = true;
+        return refactor();
+    };
+
+    NewtonStepReport step;
+    step.delta = std::numeric_limits<double>::infinity();
+    std::copy(y, y + m, z);
+    if (!(workspace.jacobianValid ? workspace.factoredStep == h || refactor() : evaluateJacobian())) {
+        step.status = EULER_STATUS_ERROR_SINGULAR_JACOBIAN;
+        return step;
+    }
+
+    // Predictor z = y + h (I - h J)^-1 f(t, y), which is exact for linear systems and, unlike the explicit Euler
+    // prediction, stays bounded for stiff ones.
+    if (workspace.slopeValid) {
+        std::copy(slope, slope + m, residual);
+        stats ? measureOperation(*stats, stats->linearAlgebra, solve) : solve();
+        for (auto j = 0; j < m; j++) {
+            z[j] += h * residual[j];
+        }
+    }
+
+    // Newton loop
+    auto previousDelta = std::numeric_limits<double>::infinity();
+    while (step.delta > tolerance) {
+        if (step.iterations >= maxIterations) {
+            step.status = EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE;
+            break;
+        }
+
+        // Residual -(z - y - h f(t, z)), which becomes the update once solved for.
+        f(t, z, residual);
+        for (auto j = 0; j < m; j++) {
+            residual[j] = -(z[j] - h * residual[j] - y[j]);
+        }
+        stats ? measureOperation(*stats, stats->linearAlgebra, solve) : solve();
+
+        step.delta = 0;
+        auto finite = true;
+        for (auto j = 0; j < m; j++) {
+            z[j] += residual[j];
+            step.delta = std::max(step.delta, std::fabs(residual[j]));
+            finite = finite && std::isfinite(residual[j]);
+        }
+        step.iterations++;
+
+        // std::max drops NaN, so a NaN or infinite update from `f`, `fy` or the solve would pass for convergence.
+        if (!finite) {
+            step.delta = std::numeric_limits<double>::infinity();
+            step.status = EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE;
+            break;
+        }
+
+        auto updatedWithCurrent = current;
+        current = false;
+        if (step.delta > tolerance && step.delta > BACKWARD_EULER_SLOW_CONVERGENCE * previousDelta &&
+            !updatedWithCurrent) {
+            if (step.delta >= previousDelta) {
+                // Diverging, which an outdated Jacobian can do far from the solution: undo the update and continue
+                // from the previous iterate with the Jacobian evaluated there, as Newton's method would.
+                for (auto j = 0; j < m; j++) {
+                    z[j] -= residual[j];
+                }
+                step.delta = previousDelta;
+            }
+            if (!evaluateJacobian()) {
+                step.status = EULER_STATUS_ERROR_SINGULAR_JACOBIAN;
+                break;
+            }
+        }
+        previousDelta = step.delta;
+    }
+
+    if (step.status == EULER_STATUS_OK) {
+        for (auto j = 0; j < m; j++) {
+            slope[j] = (z[j] - y[j]) / h;
+        }
+        workspace.slopeValid = true;
+    }
+    else {
+        // Start the retry from a fresh Jacobian.
+        workspace.jacobianValid = false;
+    }
+
+    if (stats) {
+        stats->steps++;
+        if (step.status != EULER_STATUS_OK) stats->rejectedSteps++;
+        stats->recordNewtonSolve(step.iterations, step.status == EULER_STATUS_OK);
+    }
+    return step;
+}
+
+
+/**
+ * Takes a single step of the backward Euler method for the system y' = f(t, y) by solving
+ *
+ *      z - y - h f(t + h, z) = 0
+ *
+ * for z with simplified Newton's method (see `backwardEulerAttempt`). If the iteration fails to converge, the step is
+ * halved and the interval covered by substeps instead, halving again on any further failure, up to
+ * `BACKWARD_EULER_MAX_HALVINGS` times.
+ *
+ * The Jacobian, its factorization and the slope used for the prediction are kept in `workspace` from one call to the
+ * next, which assumes that each call continues from the state the previous one ended at. Call `workspace.reset()`
+ * before stepping another system or from another state. If `f` is wrapped by `instrumentSystem`, the attempts, the
+ * Newton iterations, the Jacobian evaluations and the linear algebra are recorded in its statistics.
+ *
+ * @param f the system, called as `f(t, y, dydt)`.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)` in the layout of the workspace's iteration matrix.
+ * @param m the dimension of the system.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param z the array to store the state at `t + h` in. It must not alias `y`.
+ * @param tolerance the tolerance for Newton's method, applied to the max-norm of the update.
+ * @param maxIterations the maximum number of iterations of each Newton solve.
+ * @param workspace scratch storage, already sized for `m`. Its iteration matrix decides how the Jacobian is stored.
+ * @return the outcome of the Newton solves.
+ */
+template <OdeSystem System, OdeJacobian Jacobian, typename Matrix>
+NewtonStepReport backwardEulerStep(System &f, Jacobian &fy, std::size_t m, double t, const double *y, double h,
+                                   double *z, double tolerance, int maxIterations,
+                                   NewtonWorkspace<Matrix> &workspace) {
+    auto step = backwardEulerAttempt(f, fy, m, t, y, h, z, tolerance, maxIterations, workspace);
+    if (step.status == EULER_STATUS_OK) return step;
+
+    // Cover the step with 2^halvings substeps, of which `done` are taken, starting from the state in `start`.
+    auto start = workspace.substep.data();
+    std::copy(y, y + m, start);
+    long substeps = 1;
+    long done = 0;
+    while (done < substeps) {
+        if (step.status != EULER_STATUS_OK) {
+            if (step.halvings == BACKWARD_EULER_MAX_HALVINGS) return step;
+            step.halvings++;
+            substeps *= 2;
+            done *= 2;
+        }
+
+        auto attempt = backwardEulerAttempt(f, fy, m, t + done * (h / substeps), start, h / substeps, z, tolerance,
+                                            maxIterations, workspace);
+        step.iterations += attempt.iterations;
+        step.delta = attempt.delta;
+        step.status = attempt.status;
+        if (step.status == EULER_STATUS_OK) {
+            std::copy(z, z + m, start);
+            done++;
+        }
+    }
+
+    // The slope kept for the next prediction is that of the last substep, which is still f at the end of the step.
+    return step;
+}
+
+
+/**
+ * Uses the backward Euler method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0.
+ *
+ * Each step solves the nonlinear system
+ *
+ *      z - y[i] - h f(t[i + 1], z) = 0
+ *
+ * for z = y[i + 1] with simplified Newton's method (see `backwardEulerStep`), which reuses the Jacobian and its
+ * factorization across steps and covers a step with smaller substeps when the iteration fails to converge.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)` in the layout of the workspace's iteration matrix.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param tolerance the tolerance for Newton's method, applied to the max-norm of the update.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param report if not null, resized to one entry per step and filled with the outcome of each Newton solve.
+ * @param workspace the scratch storage to use, whose iteration matrix decides how the Jacobian is stored (see
+ *        `NewtonWorkspace`). It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps, STATUS_ERROR_SINGULAR_JACOBIAN if the iteration matrix is singular,
+ *         STATUS_ERROR_INVALID_JACOBIAN_PATTERN if the iteration matrix's sparsity pattern is invalid or not of the
+ *         dimension of the system. On failure the trajectory holds the steps completed so far and the report ends at
+ *         the failing step.
+ */
+template <OdeSystem System, OdeJacobian Jacobian, typename Matrix>
+EulerStatus backwardEulerMethod(System &&f, Jacobian &&fy, Trajectory &trajectory, const std::vector<double> &y0,
+                                double t0, double t1, double tolerance, int maxIterations,
+                                std::vector<NewtonStepReport> *report, NewtonWorkspace<Matrix> &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+    if (report) report->assign(n - 1, NewtonStepReport());
+
+    // Initial conditions.
+    trajectory.time(0) = t0;
+    std::copy(y0.begin(), y0.end(), trajectory.row(0).begin());
+
+    if (workspace.resize(m) != LINEAR_ALGEBRA_STATUS_OK) {
+        trajectory.resize(1, m);
+        if (report) report->clear();
+        return EULER_STATUS_ERROR_INVALID_JACOBIAN_PATTERN;
+    }
+
+    for (auto i = 0; i < n - 1; i++) {
+        auto step = backwardEulerStep(f, fy, m, trajectory.time(i), trajectory.row(i).data(), h,
+                                      trajectory.row(i + 1).data(), tolerance, maxIterations, workspace);
+        trajectory.time(i + 1) = trajectory.time(i) + h;
+
+        if (report) (*report)[i] = step;
+        if (step.status != EULER_STATUS_OK) {
+            trajectory.resize(i + 1, m);
+            if (report) report->resize(i + 1);
+            return step.status;
+        }
+    }
+
+    return EULER_STATUS_OK;
+}
+
+
+/**
+ * Uses the backward Euler method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param tolerance the tolerance for Newton's method, applied to the max-norm of the update.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param report if not null, resized to one entry per step and filled with the outcome of each Newton solve.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps, STATUS_ERROR_SINGULAR_JACOBIAN if the iteration matrix is singular.
+ */
+template <OdeSystem System, OdeJacobian Jacobian>
+EulerStatus backwardEulerMethod(System &&f, Jacobian &&fy, Trajectory &trajectory, const std::vector<double> &y0,
+                                double t0, double t1, double tolerance = 1e-6, int maxIterations = 10,
+                                std::vector<NewtonStepReport> *report = nullptr) {
+    NewtonWorkspace<> workspace;
+    return backwardEulerMethod(f, fy, trajectory, y0, t0, t1, tolerance, maxIterations, report, workspace);
+}
+
+
+/**
+ * Uses the backward Euler method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer` instead of storing them. Only the
+ * current and the next state are kept, so long runs need memory proportional to the dimension of the system only.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)` in the layout of the workspace's iteration matrix.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param tolerance the tolerance for Newton's method, applied to the max-norm of the update.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param workspace the scratch storage to use, whose iteration matrix decides how the Jacobian is stored (see
+ *        `NewtonWorkspace`). It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps, STATUS_ERROR_SINGULAR_JACOBIAN if the iteration matrix is singular,
+ *         STATUS_ERROR_INVALID_JACOBIAN_PATTERN (before observing anything) if the iteration matrix's sparsity
+ *         pattern is invalid or not of the dimension of the system. The failing step is not observed.
+ */
+template <OdeSystem System, OdeJacobian Jacobian, SolverObserver Observer, typename Matrix>
+EulerStatus backwardEulerMethod(System &&f, Jacobian &&fy, const std::vector<double> &y0, double t0, double t1, int n,
+                                Observer &&observer, int every, double tolerance, int maxIterations,
+                                NewtonWorkspace<Matrix> &workspace) {
+    auto m = y0.size();
+    if (workspace.resize(m) != LINEAR_ALGEBRA_STATUS_OK) return EULER_STATUS_ERROR_INVALID_JACOBIAN_PATTERN;
+
+    auto status = EULER_STATUS_OK;
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        status = backwardEulerStep(f, fy, m, t, y, h, yNext, tolerance, maxIterations, workspace).status;
+        return status == EULER_STATUS_OK;
+    };
+    integrateFixedSteps(step, y0, t0, t1, n, observer, every, workspace.states.data(), workspace.states.data() + m);
+
+    return status;
+}
+
+
+/**
+ * Uses the backward Euler method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer`, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param tolerance the tolerance for Newton's method, applied to the max-norm of the update.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps, STATUS_ERROR_SINGULAR_JACOBIAN if the iteration matrix is singular.
+ */
+template <OdeSystem System, OdeJacobian Jacobian, SolverObserver Observer>
+EulerStatus backwardEulerMethod(System &&f, Jacobian &&fy, const std::vector<double> &y0, double t0, double t1, int n,
+                                Observer &&observer, int every = 1, double tolerance = 1e-6, int maxIterations = 10) {
+    NewtonWorkspace<> workspace;
+    return backwardEulerMethod(f, fy, y0, t0, t1, n, observer, every, tolerance, maxIterations, workspace);
+}
 
 #endif // CHAPTER_6_BACK_EULER_METHOD_H
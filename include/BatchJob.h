@@ -0,0 +1,164 @@
+#pragma once
+#ifndef CHAPTER_6_BATCH_JOB_H
+#define CHAPTER_6_BATCH_JOB_H
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+
+enum BatchStatus {
+    BATCH_STATUS_OK = 0,
+    BATCH_STATUS_ERROR_OPEN_FAILED = 1,
+    BATCH_STATUS_ERROR_INVALID_JOB = 2,
+    BATCH_STATUS_ERROR_PARSE_FAILED = 3,
+    BATCH_STATUS_ERROR_SOLVER_FAILED = 4,
+    BATCH_STATUS_ERROR_WRITE_FAILED = 5
+};
+
+enum BatchMethod {
+    BATCH_METHOD_BACKWARD_EULER = 0,
+    BATCH_METHOD_TRAPEZOIDAL = 1,
+    BATCH_METHOD_RUNGE_KUTTA = 2,
+    BATCH_METHOD_DORMAND_PRINCE = 3
+};
+
+enum BatchSystem {
+    // The right-hand sides are given as exprtk expressions of `t` and `y` (see `ExpressionSystem`).
+    BATCH_SYSTEM_EXPRESSIONS = 0,
+    // The pendulum of the interactive demo. Coordinates are: theta, omega. Parameters: gravity (9.81), length (1) and
+    // drag (0).
+    BATCH_SYSTEM_PENDULUM = 1,
+    // The orbit of the interactive demo, with time in seconds. Coordinates are: sx, sy, vx, vy. The initial conditions
+    // default to those of the demo.
+    BATCH_SYSTEM_ORBIT = 2,
+    // The SIR model of the interactive demo, solved for the fractions of the population. Coordinates are: s, i, r.
+    // Parameters: b and k (both required).
+    BATCH_SYSTEM_SIR = 3
+};
+
+
+/**
+ * A single run of a batch: which method solves which system, over which interval, and where the trajectory goes.
+ */
+struct BatchJob {
+    std::string name;
+    BatchMethod method = BATCH_METHOD_RUNGE_KUTTA;
+    BatchSystem system = BATCH_SYSTEM_EXPRESSIONS;
+
+    // The expression of each component, for BATCH_SYSTEM_EXPRESSIONS.
+    std::vector<std::string> expressions;
+
+    // Parameters of the built-in systems and of the method (`relativeTolerance` and `absoluteTolerance` of the
+    // Dormand-Prince method, `tolerance` of Newton's method in the backward Euler method). Missing ones take the
+    // defaults of the systems and of the solvers.
+    std::map<std::string, double> parameters;
+
+    // The initial conditions. Only the orbit has defaults.
+    std::vector<double> y0;
+
+    // The number of time points of the fixed-step methods, including the initial one.
+    int n = 1000;
+    double t0 = 0;
+    double t1 = 1;
+
+    // The trajectory file to write. Nothing is written if empty.
+    std::string output;
+
+    // The line of the job file the job starts on, for error messages.
+    int line = 0;
+};
+
+
+/**
+ * The outcome of running a `BatchJob`.
+ */
+struct BatchJobResult {
+    BatchStatus status = BATCH_STATUS_OK;
+    std::string message;
+
+    // Whether the job used expressions compiled for an earlier job.
+    bool reusedExpressions = false;
+
+    // The number of time points in the trajectory.
+    std::size_t points = 0;
+
+    // The wall-clock time spent in the solver, and in the whole job including compiling and writing the output.
+    double solverSeconds = 0;
+    double totalSeconds = 0;
+};
+
+
+/**
+ * Read the jobs of a batch from a stream. Jobs are sections started by a `[name]` line, followed by one `key = value`
+ * line per setting:
+ *
+ *      # The orbit for 27 days with the Runge-Kutta method.
+ *      [orbit]
+ *      method = rk4
+ *      system = orbit
+ *      n = 100000
+ *      t1 = 2332800
+ *      output = ../output/orbit.txt
+ *
+ *      [decay]
+ *      method = backward-euler
+ *      f = -10 * y[0]
+ *      y0 = 1
+ *      n = 1000
+ *      t1 = 1
+ *      output = ../output/decay.txt
+ *
+ * The keys are `method` (backward-euler, trapezoidal, rk4 or dormand-prince), `system` (expressions, pendulum, orbit
+ * or sir), `f` (one line per component, in order, for expression systems), `y0` (the initial conditions, separated by
+ * spaces), `n`, `t0`, `t1`, `output`, and the numeric parameters of the system and method (see `BatchJob`). The
+ * method defaults to rk4 and the system to expressions. Blank lines and lines starting with `#` are ignored.
+ *
+ * @param stream the stream to read from.
+ * @param jobs the vector to append the jobs to.
+ * @param error a description of the first invalid line, if any.
+ * @return STATUS_OK if every job is valid, STATUS_ERROR_INVALID_JOB otherwise.
+ */
+BatchStatus readBatchJobs(std::istream &stream, std::vector<BatchJob> &jobs, std::string &error);
+
+/**
+ * Read the jobs of a batch from a file (see `readBatchJobs`).
+ * @param filename the job file to read.
+ * @param jobs the vector to append the jobs to.
+ * @param error a description of the first invalid line, if any.
+ * @return STATUS_OK if every job is valid, STATUS_ERROR_OPEN_FAILED if the file could not be opened or
+ *         STATUS_ERROR_INVALID_JOB otherwise.
+ */
+BatchStatus readBatchJobs(const std::string &filename, std::vector<BatchJob> &jobs, std::string &error);
+
+
+/**
+ * Run the jobs of a batch concurrently on a thread pool.
+ *
+ * Compiled expression systems are kept in a shared cache and handed out to one job at a time, so jobs with the same
+ * expressions only compile them as many times as they run at once, however many such jobs there are. Every job writes
+ * only its own output file, and a failing job does not affect the others.
+ *
+ * @param pool the thread pool to run on.
+ * @param jobs the jobs to run.
+ * @return the result of each job, in the order of `jobs`.
+ */
+std::vector<BatchJobResult> runBatchJobs(ThreadPool &pool, const std::vector<BatchJob> &jobs);
+
+
+/**
+ * Print one line per job (name, method, system, number of points, solver and total time, and status) followed by the
+ * total time of the jobs and the wall-clock time of the batch. Their ratio is the speedup from running the jobs
+ * concurrently.
+ * @param stream the stream to write to.
+ * @param jobs the jobs that were run.
+ * @param results the result of each job.
+ * @param wallSeconds the wall-clock time of the whole batch.
+ */
+void printBatchSummary(std::ostream &stream, const std::vector<BatchJob> &jobs,
+                       const std::vector<BatchJobResult> &results, double wallSeconds);
+
+#endif // CHAPTER_6_BATCH_JOB_H
@@ -0,0 +1,320 @@
+#pragma once
+#ifndef CHAPTER_6_BUTCHER_TABLEAU_H
+#define CHAPTER_6_BUTCHER_TABLEAU_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "OdeSystem.h"
+#include "SolverStats.h"
+#include "StepperWorkspace.h"
+
+
+/**
+ * The coefficients of an explicit Runge-Kutta method with `S` stages:
+ *
+ *      k_i = f(t + c_i h, y + h (a_i1 k_1 + ... + a_i(i-1) k_(i-1)))
+ *      y(t + h) = y + h (b_1 k_1 + ... + b_S k_S)
+ *
+ * Embedded pairs also give the error weights e_i = b_i - bHat_i, where bHat are the weights of the lower order
+ * solution, so that h (e_1 k_1 + ... + e_S k_S) estimates the local error.
+ *
+ * Tableaus are `constexpr` data: every scheme is advanced by the same `explicitRungeKuttaStep`, and adding a scheme
+ * needs nothing but a new tableau.
+ */
+template <std::size_t S>
+struct ButcherTableau {
+    static constexpr std::size_t stages = S;
+
+    // Strictly lower triangular stage coefficients.
+    double a[S][S] = {};
+    double b[S] = {};
+    double c[S] = {};
+
+    // Error weights b - bHat, all zero if the method has no embedded solution.
+    double e[S] = {};
+
+    // The order of the solution and of the embedded solution (0 if there is none).
+    int order = 0;
+    int embeddedOrder = 0;
+
+    // Whether the last stage is evaluated at the new state (a_S = b), so it is the first stage of the next step.
+    bool firstSameAsLast = false;
+};
+
+
+/**
+ * Forward Euler method, order 1.
+ */
+inline constexpr ButcherTableau<1> EULER_TABLEAU = {
+    .a = {{0}},
+    .b = {1},
+    .c = {0},
+    .order = 1
+};
+
+/**
+ * Heun's method (the explicit trapezoidal rule), order 2.
+ */
+inline constexpr ButcherTableau<2> HEUN_TABLEAU = {
+    .a = {{0, 0}, {1, 0}},
+    .b = {1.0 / 2, 1.0 / 2},
+    .c = {0, 1},
+    .order = 2
+};
+
+/**
+ * Explicit midpoint method, order 2.
+ */
+inline constexpr ButcherTableau<2> MIDPOINT_TABLEAU = {
+    .a = {{0, 0}, {1.0 / 2, 0}},
+    .b = {0, 1},
+    .c = {0, 1.0 / 2},
+    .order = 2
+};
+
+/**
+ * The classical Runge-Kutta method, order 4.
+ */
+inline constexpr ButcherTableau<4> RUNGE_KUTTA_4_TABLEAU = {
+    .a = {{0, 0, 0, 0}, {1.0 / 2, 0, 0, 0}, {0, 1.0 / 2, 0, 0}, {0, 0, 1, 0}},
+    .b = {1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6},
+    .c = {0, 1.0 / 2, 1.0 / 2, 1},
+    .order = 4
+};
+
+/**
+ * Kutta's 3/8-rule, order 4.
+ */
+inline constexpr ButcherTableau<4> THREE_EIGHTHS_RULE_TABLEAU = {
+    .a = {{0, 0, 0, 0}, {1.0 / 3, 0, 0, 0}, {-1.0 / 3, 1, 0, 0}, {1, -1, 1, 0}},
+    .b = {1.0 / 8, 3.0 / 8, 3.0 / 8, 1.0 / 8},
+    .c = {0, 1.0 / 3, 2.0 / 3, 1},
+    .order = 4
+};
+
+/**
+ * The strong stability preserving method of Shu and Osher, order 3.
+ */
+inline constexpr ButcherTableau<3> SSPRK3_TABLEAU = {
+    .a = {{0, 0, 0}, {1, 0, 0}, {1.0 / 4, 1.0 / 4, 0}},
+    .b = {1.0 / 6, 1.0 / 6, 2.0 / 3},
+    .c = {0, 1, 1.0 / 2},
+    .order = 3
+};
+
+/**
+ * Heun's method with an embedded Euler step, order 2(1).
+ */
+inline constexpr ButcherTableau<2> HEUN_EULER_TABLEAU = {
+    .a = {{0, 0}, {1, 0}},
+    .b = {1.0 / 2, 1.0 / 2},
+    .c = {0, 1},
+    .e = {-1.0 / 2, 1.0 / 2},
+    .order = 2,
+    .embeddedOrder = 1
+};
+
+/**
+ * The Bogacki-Shampine method, order 3(2).
+ */
+inline constexpr ButcherTableau<4> BOGACKI_SHAMPINE_TABLEAU = {
+    .a = {{0, 0, 0, 0}, {1.0 / 2, 0, 0, 0}, {0, 3.0 / 4, 0, 0}, {2.0 / 9, 1.0 / 3, 4.0 / 9, 0}},
+    .b = {2.0 / 9, 1.0 / 3, 4.0 / 9, 0},
+    .c = {0, 1.0 / 2, 3.0 / 4, 1},
+    .e = {-5.0 / 72, 1.0 / 12, 1.0 / 9, -1.0 / 8},
+    .order = 3,
+    .embeddedOrder = 2,
+    .firstSameAsLast = true
+};
+
+/**
+ * The Dormand-Prince method, order 5(4).
+ */
+inline constexpr ButcherTableau<7> DORMAND_PRINCE_TABLEAU = {
+    .a = {
+        {0, 0, 0, 0, 0, 0, 0},
+        {1.0 / 5, 0, 0, 0, 0, 0, 0},
+        {3.0 / 40, 9.0 / 40, 0, 0, 0, 0, 0},
+        {44.0 / 45, -56.0 / 15, 32.0 / 9, 0, 0, 0, 0},
+        {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729, 0, 0, 0},
+        {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656, 0, 0},
+        {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84, 0}
+    },
+    .b = {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84, 0},
+    .c = {0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1},
+    .e = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40},
+    .order = 5,
+    .embeddedOrder = 4,
+    .firstSameAsLast = true
+};
+
+
+/**
+ * @return an identifier of the scheme, a 64-bit FNV-1a hash of its coefficients and orders. Checkpoints record it, so
+ *         that they are only resumed by the same scheme: tableaus of the same order, such as `RUNGE_KUTTA_4_TABLEAU`
+ *         and `THREE_EIGHTHS_RULE_TABLEAU`, differ in their coefficients and so in their identifiers.
+ */
+template <std::size_t S>
+constexpr std::uint64_t butcherTableauId(const ButcherTableau<S> &tableau) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&](std::uint64_t word) {
+        for (auto byte = 0; byte < 8; byte++) {
+            hash = (hash ^ ((word >> (8 * byte)) & 0xff)) * 1099511628211ull;
+        }
+    };
+
+    add(S);
+    for (std::size_t i = 0; i < S; i++) {
+        for (std::size_t l = 0; l < S; l++) {
+            add(std::bit_cast<std::uint64_t>(tableau.a[i][l]));
+        }
+        add(std::bit_cast<std::uint64_t>(tableau.b[i]));
+        add(std::bit_cast<std::uint64_t>(tableau.c[i]));
+        add(std::bit_cast<std::uint64_t>(tableau.e[i]));
+    }
+    add(tableau.order);
+    add(tableau.embeddedOrder);
+    return hash;
+}
+
+
+/**
+ * The weights of row `row` of a tableau with `S` stages: the stage coefficients a for `row < S`, b for `row == S` and
+ * the error weights e for `row == S + 1`.
+ */
+template <const auto &Tableau>
+constexpr double butcherWeight(std::size_t row, std::size_t l) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+    return row < stages ? Tableau.a[row][l] : row == stages ? Tableau.b[l] : Tableau.e[l];
+}
+
+
+/**
+ * Computes w_0 k_0[j] + ... + w_(Count-1) k_(Count-1)[j] for the weights w of row `Row` (see `butcherWeight`). The sum
+ * is expanded at compile time, so terms with zero weights are dropped entirely.
+ */
+template <const auto &Tableau, std::size_t Row, std::size_t Count, std::size_t L = 0, bool First = true, typename K>
+inline double butcherWeightedSum(const K *k, std::size_t j, double sum = 0) {
+    if constexpr (L == Count) {
+        return sum;
+    }
+    else {
+        constexpr auto weight = butcherWeight<Tableau>(Row, L);
+        if constexpr (weight == 0) {
+            return butcherWeightedSum<Tableau, Row, Count, L + 1, First>(k, j, sum);
+        }
+        else if constexpr (First) {
+            return butcherWeightedSum<Tableau, Row, Count, L + 1, false>(k, j, weight * k[L][j]);
+        }
+        else {
+            return butcherWeightedSum<Tableau, Row, Count, L + 1, false>(k, j, sum + weight * k[L][j]);
+        }
+    }
+}
+
+
+/**
+ * Evaluates stages `I`, ..., S - 1 of an explicit Runge-Kutta step, one compile-time stage at a time.
+ * @param state the array to evaluate the stages at, or `yNext` for the last stage of first-same-as-last methods.
+ */
+template <const auto &Tableau, std::size_t I, OdeSystem System, typename K>
+inline void butcherStages(System &f, std::size_t m, double t, const double *y, double h, double *yNext, K *k,
+                          double *temp) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+    if constexpr (I < stages) {
+        // The last stage of a first-same-as-last method is evaluated at the new state, so it is computed in place.
+        auto state = Tableau.firstSameAsLast && I == stages - 1 ? yNext : temp;
+        for (auto j = 0; j < m; j++) {
+            state[j] = y[j] + h * butcherWeightedSum<Tableau, I, I>(k, j);
+        }
+        f(t + Tableau.c[I] * h, state, &k[I][0]);
+        butcherStages<Tableau, I + 1>(f, m, t, y, h, yNext, k, temp);
+    }
+}
+
+
+/**
+ * Takes a single step of the explicit Runge-Kutta method given by `Tableau` for the system y' = f(t, y).
+ *
+ * The tableau is a template argument, so its coefficients are compile-time constants: the stages are expanded one by
+ * one and terms with zero coefficients are dropped.
+ *
+ * @param f the system, called as `f(t, y, dydt)`.
+ * @param m the dimension of the system.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param yNext the array to store the state at `t + h` in. It must not alias `y`.
+ * @param workspace scratch storage, already sized for `m` and at least `Tableau.stages` stages. The slope of stage
+ *        `i` is left in `workspace.stage(i)`.
+ * @param error if not null, the array to store the local error estimate of an embedded pair in.
+ * @param firstStageKnown whether `workspace.stage(0)` already holds f(t, y), as after a step of a first-same-as-last
+ *        method.
+ */
+template <const auto &Tableau, OdeSystem System>
+void explicitRungeKuttaStep(System &f, std::size_t m, double t, const double *y, double h, double *yNext,
+                            StepperWorkspace &workspace, double *error = nullptr, bool firstStageKnown = false) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    double *k[stages];
+    for (std::size_t i = 0; i < stages; i++) {
+        k[i] = workspace.stage(i);
+    }
+
+    if (auto stats = solverStats(f)) stats->steps++;
+
+    if (!firstStageKnown) f(t, y, k[0]);
+    butcherStages<Tableau, 1>(f, m, t, y, h, yNext, k, workspace.temp());
+
+    if constexpr (!Tableau.firstSameAsLast) {
+        for (auto j = 0; j < m; j++) {
+            yNext[j] = y[j] + h * butcherWeightedSum<Tableau, stages, stages>(k, j);
+        }
+    }
+
+    if (error) {
+        for (auto j = 0; j < m; j++) {
+            error[j] = h * butcherWeightedSum<Tableau, stages + 1, stages>(k, j);
+        }
+    }
+}
+
+
+/**
+ * Takes a single step of the explicit Runge-Kutta method given by `Tableau` for a system of fixed dimension `N`.
+ *
+ * Both the tableau and the dimension are known at compile time, so the loops can be fully unrolled and the state and
+ * slopes kept in registers.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @return the state at `t + h`.
+ */
+template <const auto &Tableau, std::size_t N, OdeSystem System>
+std::array<double, N> explicitRungeKuttaStep(System &f, double t, const std::array<double, N> &y, double h) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    std::array<double, N> k[stages];
+    std::array<double, N> temp;
+    std::array<double, N> yNext;
+
+    if (auto stats = solverStats(f)) stats->steps++;
+
+    f(t, y.data(), k[0].data());
+    butcherStages<Tableau, 1>(f, N, t, y.data(), h, yNext.data(), k, temp.data());
+
+    if constexpr (!Tableau.firstSameAsLast) {
+        for (auto j = 0; j < N; j++) {
+            yNext[j] = y[j] + h * butcherWeightedSum<Tableau, stages, stages>(k, j);
+        }
+    }
+    return yNext;
+}
+
+#endif // CHAPTER_6_BUTCHER_TABLEAU_H
@@ -0,0 +1,194 @@
+#pragma once
+#ifndef CHAPTER_6_CHECKPOINT_H
+#define CHAPTER_6_CHECKPOINT_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Observer.h"
+
+enum CheckpointStatus {
+    CHECKPOINT_STATUS_OK = 0,
+    CHECKPOINT_STATUS_ERROR_OPEN_FAILED = 1,
+    CHECKPOINT_STATUS_ERROR_IO_FAILED = 2,
+    CHECKPOINT_STATUS_ERROR_INVALID_FORMAT = 3
+};
+
+enum CheckpointMethod : std::uint32_t {
+    // A new checkpoint, not yet advanced by any solver.
+    CHECKPOINT_METHOD_NONE = 0,
+    // A fixed-step explicit Runge-Kutta method (including the trapezoidal method). There is no history.
+    CHECKPOINT_METHOD_EXPLICIT_RUNGE_KUTTA = 1,
+    // An adaptive embedded Runge-Kutta pair (such as Dormand-Prince). The history is the first stage of the next step,
+    // the error of the last accepted step and whether the last attempt was rejected.
+    CHECKPOINT_METHOD_EMBEDDED_RUNGE_KUTTA = 2
+};
+
+
+/**
+ * The complete state of an integration in progress, from which a solver continues exactly as if it had never stopped.
+ *
+ * A solver that is given a checkpoint advances it in place: start from `Checkpoint(y0, t0, h)` to run from the
+ * initial conditions, or from one read with `readCheckpoint` to resume an interrupted run or to extend a finished one
+ * to a later final time. Only the remaining interval is integrated.
+ */
+struct Checkpoint {
+    Checkpoint() = default;
+
+    /**
+     * @param y0 the initial condition vector.
+     * @param t0 the initial time.
+     * @param h the step size of fixed-step methods, or the first step size to try for adaptive ones (0 picks one
+     *        automatically).
+     */
+    Checkpoint(const std::vector<double> &y0, double t0, double h = 0) : t(t0), h(h), y(y0) {}
+
+    // The method that advanced the checkpoint, its order and the identifier of its tableau (see `butcherTableauId`),
+    // so it is not resumed with a different one.
+    CheckpointMethod method = CHECKPOINT_METHOD_NONE;
+    std::uint32_t order = 0;
+    std::uint64_t tableau = 0;
+
+    // The number of steps taken (accepted steps for adaptive methods) since the initial conditions.
+    std::uint64_t step = 0;
+
+    // The current time, state and step size.
+    double t = 0;
+    double h = 0;
+    std::vector<double> y;
+
+    // Method-internal state carried from one step to the next (see `CheckpointMethod`).
+    std::vector<double> history;
+};
+
+
+/**
+ * How often a solver writes its checkpoint to a file.
+ */
+struct CheckpointOptions {
+    // The file to write to. Nothing is written if empty.
+    std::string filename;
+
+    // Write every `every` steps (accepted steps for adaptive methods) and when the solver returns, or only when it
+    // returns if zero.
+    long every = 0;
+};
+
+
+/**
+ * The 72 byte header at the start of a checkpoint file. All fields are little-endian: the header is written as it is
+ * laid out in memory, so only little-endian targets are supported. It is followed by the `dimension` values of the
+ * state and the `historySize` values of the history, as doubles.
+ */
+struct CheckpointFileHeader {
+    char magic[8] = {'C', '6', 'C', 'K', 'P', 'T', '\0', '\0'};
+    std::uint32_t version = 2;
+    std::uint32_t method = CHECKPOINT_METHOD_NONE;
+    std::uint32_t order = 0;
+    std::uint32_t reserved = 0;
+    std::uint64_t tableau = 0;
+    std::uint64_t dimension = 0;
+    std::uint64_t historySize = 0;
+    std::uint64_t step = 0;
+    double t = 0;
+    double h = 0;
+};
+
+static_assert(sizeof(CheckpointFileHeader) == 72, "the checkpoint file header must be exactly 72 bytes");
+static_assert(std::endian::native == std::endian::little, "checkpoint files are little-endian");
+
+
+/**
+ * Write a checkpoint to a file. The file is written under a temporary name and then renamed, so a run killed while
+ * writing leaves the previous checkpoint intact.
+ * @param filename the file to write.
+ * @param checkpoint the checkpoint to write.
+ * @return STATUS_OK if the file was written, STATUS_ERROR_OPEN_FAILED if it could not be opened or
+ *         STATUS_ERROR_IO_FAILED if writing failed.
+ */
+CheckpointStatus writeCheckpoint(const std::string &filename, const Checkpoint &checkpoint);
+
+/**
+ * Read a checkpoint from a file.
+ * @param filename the file to read.
+ * @param checkpoint the checkpoint to store the result in. It is left unchanged unless reading succeeds.
+ * @return STATUS_OK if the file was read, STATUS_ERROR_OPEN_FAILED if it could not be opened,
+ *         STATUS_ERROR_IO_FAILED if reading fails or its header is truncated, or STATUS_ERROR_INVALID_FORMAT if it
+ *         is not a checkpoint file or holds fewer values than its header says (checked before anything is allocated).
+ */
+CheckpointStatus readCheckpoint(const std::string &filename, Checkpoint &checkpoint);
+
+
+/**
+ * Decides whether a solver should bring its checkpoint up to date (and write it, if `options` names a file) after the
+ * step that produced state number `step`.
+ * @param options where and how often to write.
+ * @param step the number of steps taken.
+ * @param final whether the solver is about to return. The checkpoint is always brought up to date then.
+ */
+inline bool checkpointDue(const CheckpointOptions &options, std::uint64_t step, bool final) {
+    return final || (!options.filename.empty() && options.every > 0 && step % options.every == 0);
+}
+
+/**
+ * Writes a checkpoint to the file named by `options`, if any.
+ * @return false if writing failed.
+ */
+inline bool saveCheckpoint(const CheckpointOptions &options, const Checkpoint &checkpoint) {
+    return options.filename.empty() || writeCheckpoint(options.filename, checkpoint) == CHECKPOINT_STATUS_OK;
+}
+
+
+/**
+ * The fixed-step loop shared by the checkpoint variants of the explicit solvers: continues from the state in
+ * `checkpoint` with its step size up to `t1`, and leaves the final state in it.
+ * @param step the single-step function, called as `step(t, y, h, yNext)`. Returning false stops the integration.
+ * @param checkpoint the checkpoint to advance. Its step size must be positive.
+ * @param order the order of the method, recorded in the checkpoint.
+ * @param tableau the identifier of the method's tableau (see `butcherTableauId`), recorded in the checkpoint. A
+ *        checkpoint recorded by another method is rejected.
+ * @param t1 the final time. The number of steps is `(t1 - t) / h`, rounded to the nearest integer.
+ * @param observer the observer to pass the states to.
+ * @param every observe every `every`-th state, counted from the initial conditions, or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @param y storage for the current state (`checkpoint.y.size()` entries).
+ * @param yNext storage for the next state (`checkpoint.y.size()` entries).
+ * @return false if the checkpoint cannot be resumed by this method, if writing it failed or if `step` stopped the
+ *         integration.
+ */
+template <typename Step, SolverObserver Observer>
+bool integrateFixedSteps(Step &&step, Checkpoint &checkpoint, std::uint32_t order, std::uint64_t tableau, double t1,
+                         Observer &observer, int every, const CheckpointOptions &options, double *y, double *yNext) {
+    if (checkpoint.method != CHECKPOINT_METHOD_NONE &&
+        (checkpoint.method != CHECKPOINT_METHOD_EXPLICIT_RUNGE_KUTTA || checkpoint.order != order ||
+         checkpoint.tableau != tableau)) {
+        return false;
+    }
+    if (!(checkpoint.h > 0)) return false;
+    checkpoint.method = CHECKPOINT_METHOD_EXPLICIT_RUNGE_KUTTA;
+    checkpoint.order = order;
+    checkpoint.tableau = tableau;
+
+    auto m = checkpoint.y.size();
+    auto first = (long) checkpoint.step;
+    auto last = first + std::max(0L, std::lround((t1 - checkpoint.t) / checkpoint.h));
+
+    // The checkpoint is only brought up to date when it is due, so plain runs copy the state once at the end.
+    auto after = [&](long i, double t, const double *state, bool final) {
+        if (!checkpointDue(options, i, final)) return true;
+        checkpoint.step = i;
+        checkpoint.t = t;
+        std::copy(state, state + m, checkpoint.y.begin());
+        return saveCheckpoint(options, checkpoint);
+    };
+
+    std::copy(checkpoint.y.begin(), checkpoint.y.end(), y);
+    return integrateFixedSteps(step, checkpoint.t, checkpoint.h, first, last, observer, every, y, yNext, after);
+}
+
+#endif // CHAPTER_6_CHECKPOINT_H
@@ -0,0 +1,263 @@
+#pragma once
+#ifndef CHAPTER_6_CONVERGENCE_STUDY_H
+#define CHAPTER_6_CONVERGENCE_STUDY_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "BackwardEulerMethod.h"
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "RungeKuttaMethod.h"
+#include "ThreadPool.h"
+#include "Trajectory.h"
+#include "TrapezoidalMethod.h"
+
+enum ConvergenceStatus {
+    CONVERGENCE_STATUS_OK = 0,
+    CONVERGENCE_STATUS_ERROR_SOLVER_FAILED = 1,
+    CONVERGENCE_STATUS_ERROR_TOLERANCE_NOT_MET = 2,
+    CONVERGENCE_STATUS_ERROR_INVALID_OPTIONS = 3
+};
+
+
+/**
+ * Settings of a convergence study.
+ */
+struct ConvergenceOptions {
+    // The number of time points of the coarsest integration, including the initial one. Each further integration takes
+    // twice as many steps as the previous one, so integration k has (n - 1) 2^k + 1 time points.
+    int n = 101;
+
+    // The number of integrations, at least 2 and at most 31. The observed order needs at least 3. The finest
+    // integration's number of time points must fit in an int.
+    int levels = 4;
+
+    // The largest acceptable global error, in the max-norm over the components and the time points of the coarsest
+    // integration.
+    double tolerance = 1e-6;
+
+    // Whether to also compute the Richardson extrapolation of the two finest integrations.
+    bool extrapolate = false;
+};
+
+
+/**
+ * The outcome of one integration of a convergence study.
+ */
+struct ConvergenceLevel {
+    // The number of time points.
+    int n = 0;
+
+    // The status returned by the solver, 0 if it succeeded.
+    int status = 0;
+
+    // The max-norm of the difference from the next finer integration, NaN for the finest.
+    double difference = 0;
+
+    // The order observed from the differences of this integration and the next two, NaN if there are not enough.
+    double order = 0;
+
+    // The estimated max-norm of the global error.
+    double error = 0;
+
+    // The wall-clock time of the integration.
+    double seconds = 0;
+};
+
+
+/**
+ * The outcome of a convergence study.
+ */
+struct ConvergenceResult {
+    // STATUS_OK if one of the integrations meets the tolerance, STATUS_ERROR_TOLERANCE_NOT_MET if none does,
+    // STATUS_ERROR_SOLVER_FAILED if any of them failed, STATUS_ERROR_INVALID_OPTIONS if the options are invalid (see
+    // `checkConvergenceOptions`), in which case nothing is integrated.
+    ConvergenceStatus status = CONVERGENCE_STATUS_OK;
+
+    // The integrations, from the coarsest to the finest.
+    std::vector<ConvergenceLevel> levels;
+
+    // The order the error estimates and the extrapolation use: the order observed from the three finest integrations
+    // if it is positive, or the order of the method otherwise.
+    double order = 0;
+
+    // The cheapest number of time points that meets the tolerance. If no integration does, the number predicted to
+    // meet it from the error of the finest one and `order`.
+    int n = 0;
+
+    // The estimated error with `n` time points.
+    double error = 0;
+
+    // The solution at the time points of the coarsest integration: the finest one, or its Richardson extrapolation
+    //
+    //      y[L - 1] + (y[L - 1] - y[L - 2]) / (2^order - 1)
+    //
+    // if `ConvergenceOptions::extrapolate` is set, which cancels the leading error term.
+    Trajectory solution;
+};
+
+
+/**
+ * Check the settings of a convergence study: at least 2 time points, between 2 and 31 integrations, a finest
+ * integration whose number of time points fits in an int and a positive tolerance.
+ * @param options the settings of the study.
+ * @return STATUS_OK if they are valid, STATUS_ERROR_INVALID_OPTIONS otherwise.
+ */
+ConvergenceStatus checkConvergenceOptions(const ConvergenceOptions &options);
+
+
+/**
+ * Estimate the order and the global errors of a set of integrations, each with twice as many steps as the previous
+ * one, by Richardson extrapolation, and fill in `result` (see `convergenceStudy`).
+ * @param solutions the solution of each integration at the time points of the coarsest one. They are consumed.
+ * @param methodOrder the order of the method, used when no order can be observed.
+ * @param options the settings of the study.
+ * @param result the result to fill in. Its levels must already hold the number of time points, status and time of
+ *        each integration. Its status is set to STATUS_ERROR_INVALID_OPTIONS if there are fewer than 2 of them, or
+ *        not one solution per level.
+ */
+void analyzeConvergence(std::vector<Trajectory> &solutions, int methodOrder, const ConvergenceOptions &options,
+                        ConvergenceResult &result);
+
+
+/**
+ * Integrates a system with (n - 1) 2^k + 1 time points for k = 0, ..., levels - 1 concurrently and estimates the
+ * global error of each integration by Richardson extrapolation. The difference d[k] between integrations k and k + 1
+ * at the time points of the coarsest one gives the observed order, log2(d[k] / d[k + 1]), and the errors
+ *
+ *      e[k] = d[k] 2^p / (2^p - 1), e[L - 1] = d[L - 2] / (2^p - 1)
+ *
+ * where p is the observed order of the three finest integrations, or the order of the method if none is observed.
+ * The result gives the cheapest of the integrations that meets the tolerance and, optionally, the extrapolated
+ * solution, which is usually far more accurate than any of them.
+ *
+ * The integrations run on the pool, but the finest one takes half of the total work, so the study takes about twice
+ * as long as the finest integration alone however many threads there are.
+ *
+ * @param pool the thread pool to run on.
+ * @param solve a single integration, called as `solve(n, every, trajectory)` from several threads at once. It must
+ *        integrate with `n` time points, store every `every`-th of them (and the final one) in `trajectory` and
+ *        return 0 on success.
+ * @param methodOrder the order of the method.
+ * @param options the settings of the study.
+ * @return the result of the study, with STATUS_ERROR_INVALID_OPTIONS and no levels if the options are invalid.
+ */
+template <typename Solve>
+ConvergenceResult convergenceStudy(ThreadPool &pool, Solve &&solve, int methodOrder,
+                                   const ConvergenceOptions &options) {
+    ConvergenceResult result;
+    result.status = checkConvergenceOptions(options);
+    if (result.status != CONVERGENCE_STATUS_OK) return result;
+
+    result.levels.resize(options.levels);
+    std::vector<Trajectory> solutions(options.levels);
+
+    pool.parallelFor(options.levels, [&](std::size_t k) {
+        auto &level = result.levels[k];
+        auto start = std::chrono::steady_clock::now();
+        level.n = (options.n - 1) * (1 << k) + 1;
+        level.status = solve(level.n, 1 << k, solutions[k]);
+        level.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    analyzeConvergence(solutions, methodOrder, options, result);
+    return result;
+}
+
+
+/**
+ * Run a convergence study (see `convergenceStudy`) of the backward Euler method on a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0. Newton's method is iterated to a hundredth of the study's tolerance,
+ * so that it does not limit the accuracy.
+ *
+ * @param pool the thread pool to run on.
+ * @param f the system, called as `f(t, y, dydt)` from several threads at once.
+ * @param fy the Jacobian of `f`, called as `fy(t, y, jacobian)`. Each integration uses its own copy.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param options the settings of the study.
+ * @return the result of the study.
+ */
+template <OdeSystem System, OdeJacobian Jacobian>
+ConvergenceResult backwardEulerConvergenceStudy(ThreadPool &pool, System &&f, const Jacobian &fy,
+                                                const std::vector<double> &y0, double t0, double t1,
+                                                const ConvergenceOptions &options = {}) {
+    auto solve = [&](int n, int every, Trajectory &trajectory) {
+        auto jacobian = fy;
+        TrajectoryRecorder recorder(trajectory, y0.size(), options.n);
+        return (int) backwardEulerMethod(f, jacobian, y0, t0, t1, n, recorder, every, options.tolerance / 100);
+    };
+    return convergenceStudy(pool, solve, 1, options);
+}
+
+
+/**
+ * Run a convergence study (see `convergenceStudy`) of the trapezoidal method on a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0.
+ *
+ * @param pool the thread pool to run on.
+ * @param f the system, called as `f(t, y, dydt)` from several threads at once.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param options the settings of the study.
+ * @return the result of the study.
+ */
+template <OdeSystem System>
+ConvergenceResult trapezoidalConvergenceStudy(ThreadPool &pool, System &&f, const std::vector<double> &y0, double t0,
+                                              double t1, const ConvergenceOptions &options = {}) {
+    auto solve = [&](int n, int every, Trajectory &trajectory) {
+        TrajectoryRecorder recorder(trajectory, y0.size(), options.n);
+        return (int) trapezoidalMethod(f, y0, t0, t1, n, recorder, every);
+    };
+    return convergenceStudy(pool, solve, HEUN_TABLEAU.order, options);
+}
+
+
+/**
+ * Run a convergence study (see `convergenceStudy`) of the Runge-Kutta method of order 4 on a system of ODEs of the
+ * form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0.
+ *
+ * @param pool the thread pool to run on.
+ * @param f the system, called as `f(t, y, dydt)` from several threads at once.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param options the settings of the study.
+ * @return the result of the study.
+ */
+template <OdeSystem System>
+ConvergenceResult rungeKuttaConvergenceStudy(ThreadPool &pool, System &&f, const std::vector<double> &y0, double t0,
+                                             double t1, const ConvergenceOptions &options = {}) {
+    auto solve = [&](int n, int every, Trajectory &trajectory) {
+        TrajectoryRecorder recorder(trajectory, y0.size(), options.n);
+        return (int) rungeKuttaMethod(f, y0, t0, t1, n, recorder, every);
+    };
+    return convergenceStudy(pool, solve, RUNGE_KUTTA_4_TABLEAU.order, options);
+}
+
+
+/**
+ * Print one line per integration of a convergence study (number of time points, difference from the next one,
+ * observed order, estimated error and time), followed by the chosen number of time points.
+ * @param stream the stream to write to.
+ * @param result the result of the study.
+ * @param options the settings of the study.
+ */
+void printConvergenceSummary(std::ostream &stream, const ConvergenceResult &result, const ConvergenceOptions &options);
+
+#endif // CHAPTER_6_CONVERGENCE_STUDY_H
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef CHAPTER_6_CSV_WRITER_H
+#define CHAPTER_6_CSV_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <span>
+#include <vector>
+
+
+/**
+ * Writes comma separated rows of doubles to a stream through a large buffer.
+ *
+ * Values are formatted with `std::to_chars`, which gives the shortest text that reads back as exactly the same double
+ * and ignores the locale. The buffer is only handed to the stream when it fills up or the writer is flushed, and the
+ * stream itself is never flushed, so there is no per-row cost beyond formatting.
+ */
+class CsvWriter {
+public:
+    /**
+     * @param stream the stream to write to. It must outlive the writer.
+     * @param capacity the size of the output buffer in bytes.
+     */
+    explicit CsvWriter(std::ostream &stream, std::size_t capacity = 1 << 20);
+
+    /**
+     * Flushes the remaining buffered output to the stream.
+     */
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter &) = delete;
+    CsvWriter &operator=(const CsvWriter &) = delete;
+
+    /**
+     * Appends a value to the current row.
+     * @param value the value to write.
+     */
+    void value(double value) {
+        reserve(maxValueLength);
+        if (rowStarted) {
+            buffer[used++] = ',';
+            buffer[used++] = ' ';
+        }
+        auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+        used = result.ptr - buffer.data();
+        rowStarted = true;
+    }
+
+    /**
+     * Appends several values to the current row.
+     * @param values the values to write.
+     */
+    void values(std::span<const double> values) {
+        for (auto value : values) {
+            this->value(value);
+        }
+    }
+
+    /**
+     * Ends the current row.
+     */
+    void endRow() {
+        reserve(1);
+        buffer[used++] = '\n';
+        rowStarted = false;
+    }
+
+    /**
+     * Writes a whole row of the form `t, y1, ..., yn`.
+     * @param t the first value.
+     * @param y the remaining values.
+     */
+    void row(double t, std::span<const double> y) {
+        value(t);
+        values(y);
+        endRow();
+    }
+
+    /**
+     * Hands the buffered output to the stream.
+     */
+    void flush();
+
+private:
+    // Longest output of `value`: the separator plus the longest shortest-round-trip double
+    // (such as -2.2250738585072014e-308).
+    static constexpr std::size_t maxValueLength = 32;
+
+    void reserve(std::size_t length) {
+        if (buffer.size() - used < length) flush();
+    }
+
+    std::ostream &stream;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    bool rowStarted = false;
+};
+
+#endif // CHAPTER_6_CSV_WRITER_H
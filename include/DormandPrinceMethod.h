@@ -0,0 +1,560 @@
+#pragma once
+#ifndef CHAPTER_6_DORMAND_PRINCE_METHOD_H
+#define CHAPTER_6_DORMAND_PRINCE_METHOD_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "ButcherTableau.h"
+#include "Checkpoint.h"
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
+
+enum DormandPrinceStatus {
+    DORMAND_PRINCE_STATUS_OK = 0,
+    DORMAND_PRINCE_STATUS_ERROR_DIMENSION_MISMATCH = 1,
+    DORMAND_PRINCE_STATUS_ERROR_STEP_SIZE_TOO_SMALL = 2,
+    DORMAND_PRINCE_STATUS_ERROR_TOO_MANY_STEPS = 3,
+    DORMAND_PRINCE_STATUS_ERROR_CHECKPOINT_FAILED = 4
+};
+
+
+/**
+ * Settings for `dormandPrinceMethod`.
+ */
+struct DormandPrinceOptions {
+    // A step is accepted when every component's local error estimate is within
+    // absoluteTolerance + relativeTolerance * |y| (in the root-mean-square sense).
+    double relativeTolerance = 1e-6;
+    double absoluteTolerance = 1e-9;
+
+    // The first step size to try. Zero picks one automatically from the initial slope.
+    double initialStep = 0;
+
+    // The largest step size that may be taken.
+    double maxStep = std::numeric_limits<double>::infinity();
+
+    // The maximum number of attempted steps (accepted or rejected) before giving up.
+    long maxSteps = 1000000;
+};
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y1' = f1(t, y1, ..., yn), t0 < t < t1
+ *          :
+ *      yn' = fn(t, y1, ..., yn), t0 < t < t1
+ *
+ * From the initial conditions:
+ *
+ *      y1(t0), ..., yn(t0)
+ *
+ * @param f the vector of functions {f1, ..., fn}.
+ * @param trajectory the trajectory to store the accepted steps in. Its previous contents are discarded.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param options the tolerances and step size limits.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the number of functions and initial
+ *         conditions does not match, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+DormandPrinceStatus dormandPrinceMethod(const std::vector<funcn> &f, Trajectory &trajectory,
+                                        const std::vector<double> &y0, double t0, double t1,
+                                        const DormandPrinceOptions &options = {});
+
+
+/**
+ * The weighted root-mean-square norm of `v` used by both the error estimate and the initial step heuristic, with every
+ * component scaled by absoluteTolerance + relativeTolerance * max(|a|, |b|).
+ */
+inline double embeddedRungeKuttaNorm(std::size_t m, const double *v, const double *a, const double *b,
+                                     const DormandPrinceOptions &options) {
+    auto sum = 0.0;
+    for (auto j = 0; j < m; j++) {
+        auto scale = options.absoluteTolerance +
+                     options.relativeTolerance * std::max(std::fabs(a[j]), std::fabs(b[j]));
+        sum += (v[j] / scale) * (v[j] / scale);
+    }
+    return m > 0 ? std::sqrt(sum / m) : 0.0;
+}
+
+
+/**
+ * The number of slope vectors a `StepperWorkspace` needs for `dormandPrinceMethod`: seven stages plus the current and
+ * the candidate state and the error estimate.
+ */
+constexpr std::size_t DORMAND_PRINCE_STAGES = DORMAND_PRINCE_TABLEAU.stages + 3;
+
+
+/**
+ * The state an embedded Runge-Kutta pair carries from one step to the next, besides the solution and its slope.
+ */
+struct EmbeddedRungeKuttaState {
+    double t = 0;
+    // The next step size to try.
+    double h = 0;
+    // The error of the last accepted step, for the PI controller.
+    double errorOld = 1e-4;
+    // Whether the last attempt was rejected, which keeps the next step from growing.
+    bool rejected = false;
+    // The number of accepted steps since the initial conditions.
+    long accepted = 0;
+};
+
+
+/**
+ * Computes the slope at the initial conditions and, unless `options.initialStep` gives one, chooses the first step
+ * size from the size of the solution and its first two derivatives.
+ * @param y the initial condition vector, in `workspace.stage(stages + 1)`.
+ * @param state the state to initialize. `state.t` must be the initial time.
+ */
+template <const auto &Tableau, OdeSystem System>
+void embeddedRungeKuttaStart(System &f, std::size_t m, const double *y, double t1, const DormandPrinceOptions &options,
+                             StepperWorkspace &workspace, EmbeddedRungeKuttaState &state) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+    auto k1 = workspace.stage(0);
+    auto k2 = workspace.stage(1);
+    auto yNew = workspace.stage(stages);
+    auto error = workspace.stage(stages + 2);
+
+    auto t0 = state.t;
+    f(t0, y, k1);
+
+    auto h = options.initialStep;
+    if (h <= 0) {
+        auto d0 = embeddedRungeKuttaNorm(m, y, y, y, options);
+        auto d1 = embeddedRungeKuttaNorm(m, k1, y, y, options);
+        auto h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+        h0 = std::min(h0, t1 - t0);
+
+        for (auto j = 0; j < m; j++) {
+            yNew[j] = y[j] + h0 * k1[j];
+        }
+        f(t0 + h0, yNew, k2);
+        for (auto j = 0; j < m; j++) {
+            error[j] = (k2[j] - k1[j]) / h0;
+        }
+        auto d2 = embeddedRungeKuttaNorm(m, error, y, y, options);
+
+        auto h1 = std::max(d1, d2) <= 1e-15 ? std::max(1e-6, h0 * 1e-3)
+                                            : std::pow(0.01 / std::max(d1, d2), 1.0 / Tableau.order);
+        h = std::min(100 * h0, h1);
+    }
+    state.h = std::min(h, options.maxStep);
+}
+
+
+/**
+ * The step loop of `embeddedRungeKuttaMethod`, continuing from `state` up to `t1`.
+ * @param y the current state, in `workspace.stage(stages + 1)`, with its slope in `workspace.stage(0)`.
+ * @param after called as `after(state, y, final)` after each accepted step has been observed, and with `final` set
+ *        before returning. Returning false stops the integration.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer, typename After>
+DormandPrinceStatus embeddedRungeKuttaSteps(System &f, std::size_t m, EmbeddedRungeKuttaState &state, double t1,
+                                            Observer &observer, int every, const DormandPrinceOptions &options,
+                                            StepperWorkspace &workspace, After &&after) {
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    // Step size controller settings (see Hairer, Norsett and Wanner, "Solving Ordinary Differential Equations I").
+    constexpr double safety = 0.9;
+    constexpr double minFactor = 0.2;
+    constexpr double maxFactor = 10;
+    constexpr double beta = 0.04;
+    constexpr double alpha = 1.0 / (Tableau.embeddedOrder + 1) - 0.75 * beta;
+
+    auto k1 = workspace.stage(0);
+    auto kLast = workspace.stage(stages - 1);
+    auto yNew = workspace.stage(stages);
+    auto y = workspace.stage(stages + 1);
+    auto error = workspace.stage(stages + 2);
+
+    auto &t = state.t;
+    auto &h = state.h;
+    auto &errorOld = state.errorOld;
+    auto &rejected = state.rejected;
+    auto &accepted = state.accepted;
+
+    // Whether `after` has been told about the final state.
+    auto finished = false;
+
+    // Reports a failure after handing the last accepted state to `after`.
+    auto fail = [&](DormandPrinceStatus status) {
+        after(state, y, true);
+        return status;
+    };
+
+    for (long steps = 0; t < t1; steps++) {
+        if (steps >= options.maxSteps) return fail(DORMAND_PRINCE_STATUS_ERROR_TOO_MANY_STEPS);
+
+        // Land exactly on t1. The step the controller proposed is kept for a later continuation past t1.
+        auto proposed = h;
+        auto last = t + h >= t1;
+        if (last) h = t1 - t;
+        if (h <= 10 * std::numeric_limits<double>::epsilon() * std::fabs(t)) {
+            h = proposed;
+            return fail(DORMAND_PRINCE_STATUS_ERROR_STEP_SIZE_TOO_SMALL);
+        }
+
+        // The first stage is always known: from the initial conditions, the previous accepted step or the rejected
+        // attempt at this one.
+        explicitRungeKuttaStep<Tableau>(f, m, t, y, h, yNew, workspace, error, true);
+        auto tNew = last ? t1 : t + h;
+
+        auto errorNorm = embeddedRungeKuttaNorm(m, error, y, yNew, options);
+        if (!std::isfinite(errorNorm)) errorNorm = std::numeric_limits<double>::max();
+
+        // PI controller: the factor to divide h by.
+        auto factor11 = std::pow(errorNorm, alpha);
+        if (errorNorm <= 1) {
+            auto factor = std::clamp(factor11 / std::pow(errorOld, beta) / safety, 1 / maxFactor, 1 / minFactor);
+            errorOld = std::max(errorNorm, 1e-4);
+
+            // Accept the step.
+            t = tNew;
+            std::swap(y, yNew);
+            if (Tableau.firstSameAsLast) {
+                // The last stage is the slope at the new point, so it becomes the next first stage.
+                std::copy(kLast, kLast + m, k1);
+            }
+            else {
+                f(t, y, k1);
+            }
+            accepted++;
+            auto stop = shouldObserve(accepted, t >= t1, every) && !observe(observer, t, y);
+
+            auto hNew = h / factor;
+            if (rejected) hNew = std::min(hNew, h);
+            h = std::min(last ? std::max(hNew, proposed) : hNew, options.maxStep);
+            rejected = false;
+
+            finished = stop || t >= t1;
+            if (!after(state, y, finished)) return DORMAND_PRINCE_STATUS_ERROR_CHECKPOINT_FAILED;
+            if (stop) return DORMAND_PRINCE_STATUS_OK;
+        }
+        else {
+            // Reject the step and retry with a smaller one.
+            h /= std::min(1 / minFactor, factor11 / safety);
+            rejected = true;
+            if (auto stats = solverStats(f)) stats->rejectedSteps++;
+        }
+    }
+
+    // Nothing was left to integrate, so no step was reported as the final one.
+    if (!finished && !after(state, y, true)) return DORMAND_PRINCE_STATUS_ERROR_CHECKPOINT_FAILED;
+    return DORMAND_PRINCE_STATUS_OK;
+}
+
+
+/**
+ * Uses the embedded explicit Runge-Kutta pair given by `Tableau` (such as `DORMAND_PRINCE_TABLEAU`,
+ * `BOGACKI_SHAMPINE_TABLEAU` or `HEUN_EULER_TABLEAU`) to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with adaptive step size control.
+ *
+ * Each step advances with the higher order solution and uses the embedded lower order solution to estimate the local
+ * error. Steps whose error exceeds the tolerances are rejected and retried with a smaller step. The next step size
+ * comes from a PI controller, which grows the step on smooth stretches without oscillating between accepts and
+ * rejects. For first-same-as-last pairs the last stage of an accepted step is the first stage of the next one, so it
+ * is not evaluated again.
+ *
+ * The accepted states are passed to `observer` instead of being stored, so long runs need memory proportional to the
+ * dimension of the system only.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param observer the observer, called as `observer(t, y)` with the initial state and the accepted steps.
+ * @param every observe every `every`-th accepted state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus embeddedRungeKuttaMethod(System &&f, const std::vector<double> &y0, double t0, double t1,
+                                             Observer &&observer, int every, const DormandPrinceOptions &options,
+                                             StepperWorkspace &workspace) {
+    static_assert(Tableau.embeddedOrder > 0, "The tableau must have an embedded solution");
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    auto m = y0.size();
+
+    // The stages are followed by the candidate state, the current state and the error estimate.
+    workspace.resize(m, stages + 3);
+    auto y = workspace.stage(stages + 1);
+
+    // Initial conditions.
+    EmbeddedRungeKuttaState state;
+    state.t = t0;
+    std::copy(y0.begin(), y0.end(), y);
+    if (shouldObserve(0, t0 >= t1, every) && !observe(observer, t0, y)) return DORMAND_PRINCE_STATUS_OK;
+    embeddedRungeKuttaStart<Tableau>(f, m, y, t1, options, workspace, state);
+
+    return embeddedRungeKuttaSteps<Tableau>(f, m, state, t1, observer, every, options, workspace,
+                                            [](const EmbeddedRungeKuttaState &, const double *, bool) {
+                                                return true;
+                                            });
+}
+
+
+/**
+ * Uses the embedded explicit Runge-Kutta pair given by `Tableau` to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with adaptive step size control, passing the accepted states to `observer`. The
+ * checkpoint holds everything the method carries between steps (the next step size, the slope at the current state
+ * and the controller's memory), so continuing from it gives exactly the same steps as an uninterrupted run. It is
+ * advanced in place and written to `checkpointing.filename` every `checkpointing.every` accepted steps and at the end.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0)` to start from the initial conditions.
+ * @param t1 the final time.
+ * @param observer the observer, called as `observer(t, y)` with the initial state (when starting from the initial
+ *        conditions) and the accepted steps.
+ * @param every observe every `every`-th accepted state (and the final one), counted from the initial conditions, or
+ *        only the final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits. The step size of a new checkpoint, if positive, overrides
+ *        `options.initialStep`.
+ * @param checkpointing where and how often to write the checkpoint.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows,
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded, or STATUS_ERROR_CHECKPOINT_FAILED if the
+ *         checkpoint was recorded by another method or if writing it failed.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus embeddedRungeKuttaMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer,
+                                             int every, const DormandPrinceOptions &options,
+                                             const CheckpointOptions &checkpointing, StepperWorkspace &workspace) {
+    static_assert(Tableau.embeddedOrder > 0, "The tableau must have an embedded solution");
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    auto m = checkpoint.y.size();
+    workspace.resize(m, stages + 3);
+    auto k1 = workspace.stage(0);
+    auto y = workspace.stage(stages + 1);
+
+    // The history is the slope at the current state, the controller's error memory and the rejection flag.
+    auto after = [&](const EmbeddedRungeKuttaState &state, const double *current, bool final) {
+        if (!checkpointDue(checkpointing, state.accepted, final)) return true;
+        checkpoint.step = state.accepted;
+        checkpoint.t = state.t;
+        checkpoint.h = state.h;
+        std::copy(current, current + m, checkpoint.y.begin());
+        std::copy(k1, k1 + m, checkpoint.history.begin());
+        checkpoint.history[m] = state.errorOld;
+        checkpoint.history[m + 1] = state.rejected ? 1 : 0;
+        return saveCheckpoint(checkpointing, checkpoint);
+    };
+
+    EmbeddedRungeKuttaState state;
+    state.t = checkpoint.t;
+    std::copy(checkpoint.y.begin(), checkpoint.y.end(), y);
+    if (checkpoint.method == CHECKPOINT_METHOD_NONE) {
+        checkpoint.method = CHECKPOINT_METHOD_EMBEDDED_RUNGE_KUTTA;
+        checkpoint.order = Tableau.order;
+        checkpoint.tableau = butcherTableauId(Tableau);
+        checkpoint.history.resize(m + 2);
+
+        auto start = options;
+        if (checkpoint.h > 0) start.initialStep = checkpoint.h;
+        embeddedRungeKuttaStart<Tableau>(f, m, y, t1, start, workspace, state);
+        if (shouldObserve(0, state.t >= t1, every) && !observe(observer, state.t, y)) {
+            return after(state, y, true) ? DORMAND_PRINCE_STATUS_OK : DORMAND_PRINCE_STATUS_ERROR_CHECKPOINT_FAILED;
+        }
+    }
+    else {
+        if (checkpoint.method != CHECKPOINT_METHOD_EMBEDDED_RUNGE_KUTTA || checkpoint.order != Tableau.order ||
+            checkpoint.tableau != butcherTableauId(Tableau) || checkpoint.history.size() != m + 2) {
+            return DORMAND_PRINCE_STATUS_ERROR_CHECKPOINT_FAILED;
+        }
+        state.h = checkpoint.h;
+        state.errorOld = checkpoint.history[m];
+        state.rejected = checkpoint.history[m + 1] != 0;
+        state.accepted = (long) checkpoint.step;
+        std::copy(checkpoint.history.begin(), checkpoint.history.begin() + m, k1);
+    }
+
+    return embeddedRungeKuttaSteps<Tableau>(f, m, state, t1, observer, every, options, workspace, after);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0: `embeddedRungeKuttaMethod` with `DORMAND_PRINCE_TABLEAU`. Each
+ * accepted step costs six evaluations of `f`.
+ *
+ * The accepted states are passed to `observer` instead of being stored, so long runs need memory proportional to the
+ * dimension of the system only.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param observer the observer, called as `observer(t, y)` with the initial state and the accepted steps.
+ * @param every observe every `every`-th accepted state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+template <OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus dormandPrinceMethod(System &&f, const std::vector<double> &y0, double t0, double t1,
+                                        Observer &&observer, int every, const DormandPrinceOptions &options,
+                                        StepperWorkspace &workspace) {
+    return embeddedRungeKuttaMethod<DORMAND_PRINCE_TABLEAU>(f, y0, t0, t1, observer, every, options, workspace);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the accepted states to `observer`, using a temporary
+ * workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param observer the observer, called as `observer(t, y)` with the initial state and the accepted steps.
+ * @param every observe every `every`-th accepted state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+template <OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus dormandPrinceMethod(System &&f, const std::vector<double> &y0, double t0, double t1,
+                                        Observer &&observer, int every = 1, const DormandPrinceOptions &options = {}) {
+    StepperWorkspace workspace;
+    return dormandPrinceMethod(f, y0, t0, t1, observer, every, options, workspace);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint`, passing the accepted states to `observer`: `embeddedRungeKuttaMethod` with
+ * `DORMAND_PRINCE_TABLEAU`.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0)` to start from the initial conditions.
+ * @param t1 the final time.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th accepted state (and the final one), counted from the initial conditions, or
+ *        only the final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits.
+ * @param checkpointing where and how often to write the checkpoint.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows,
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded, or STATUS_ERROR_CHECKPOINT_FAILED if the
+ *         checkpoint was recorded by another method or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus dormandPrinceMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer, int every,
+                                        const DormandPrinceOptions &options, const CheckpointOptions &checkpointing,
+                                        StepperWorkspace &workspace) {
+    return embeddedRungeKuttaMethod<DORMAND_PRINCE_TABLEAU>(f, checkpoint, t1, observer, every, options, checkpointing,
+                                                            workspace);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint`, passing the accepted states to `observer`, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0)` to start from the initial conditions.
+ * @param t1 the final time.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th accepted state (and the final one), counted from the initial conditions, or
+ *        only the final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options the tolerances and step size limits.
+ * @param checkpointing where and how often to write the checkpoint.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows,
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded, or STATUS_ERROR_CHECKPOINT_FAILED if the
+ *         checkpoint was recorded by another method or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+DormandPrinceStatus dormandPrinceMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer,
+                                        int every = 1, const DormandPrinceOptions &options = {},
+                                        const CheckpointOptions &checkpointing = {}) {
+    StepperWorkspace workspace;
+    return dormandPrinceMethod(f, checkpoint, t1, observer, every, options, checkpointing, workspace);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, storing every accepted step in `trajectory`.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the accepted steps in. Its previous contents are discarded.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param options the tolerances and step size limits.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+template <OdeSystem System>
+DormandPrinceStatus dormandPrinceMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                        double t1, const DormandPrinceOptions &options,
+                                        StepperWorkspace &workspace) {
+    TrajectoryRecorder recorder(trajectory, y0.size());
+    return dormandPrinceMethod(f, y0, t0, t1, recorder, 1, options, workspace);
+}
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the accepted steps in. Its previous contents are discarded.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param options the tolerances and step size limits.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+template <OdeSystem System>
+DormandPrinceStatus dormandPrinceMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                        double t1, const DormandPrinceOptions &options = {}) {
+    StepperWorkspace workspace;
+    return dormandPrinceMethod(f, trajectory, y0, t0, t1, options, workspace);
+}
+
+#endif // CHAPTER_6_DORMAND_PRINCE_METHOD_H
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef CHAPTER_6_DUAL_H
+#define CHAPTER_6_DUAL_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+
+/**
+ * A forward-mode dual number: a value together with its partial derivatives with respect to `N` independent
+ * variables.
+ *
+ * Evaluating a function written for a generic scalar type with `Dual` arguments yields the function value and its
+ * exact derivatives at the same time. Seeding `N` inputs with unit derivatives gives `N` columns of a Jacobian from a
+ * single evaluation.
+ *
+ * Arithmetic operators and the common math functions are found by argument-dependent lookup, so a function body like
+ * `-y / (1 + y * y)` or `sin(y[0])` works unchanged for both `double` and `Dual`. Comparisons only look at the value.
+ */
+template <std::size_t N = 1>
+class Dual {
+public:
+    Dual() : v(0), d{} {}
+
+    Dual(double value) : v(value), d{} {}
+
+    /**
+     * Makes the independent variable number `index`, whose derivative with respect to itself is 1.
+     */
+    Dual(double value, std::size_t index) : v(value), d{} {
+        d[index] = 1;
+    }
+
+    /**
+     * @return the value.
+     */
+    double value() const {
+        return v;
+    }
+
+    /**
+     * @return the partial derivative with respect to independent variable number `index`.
+     */
+    double derivative(std::size_t index = 0) const {
+        return d[index];
+    }
+
+    Dual &operator+=(const Dual &other) {
+        v += other.v;
+        for (std::size_t k = 0; k < N; k++) d[k] += other.d[k];
+        return *this;
+    }
+
+    Dual &operator-=(const Dual &other) {
+        v -= other.v;
+        for (std::size_t k = 0; k < N; k++) d[k] -= other.d[k];
+        return *this;
+    }
+
+    Dual &operator*=(const Dual &other) {
+        for (std::size_t k = 0; k < N; k++) d[k] = d[k] * other.v + v * other.d[k];
+        v *= other.v;
+        return *this;
+    }
+
+    Dual &operator/=(const Dual &other) {
+        auto inverse = 1 / other.v;
+        v *= inverse;
+        for (std::size_t k = 0; k < N; k++) d[k] = (d[k] - v * other.d[k]) * inverse;
+        return *this;
+    }
+
+    friend Dual operator+(Dual a, const Dual &b) { return a += b; }
+    friend Dual operator-(Dual a, const Dual &b) { return a -= b; }
+    friend Dual operator*(Dual a, const Dual &b) { return a *= b; }
+    friend Dual operator/(Dual a, const Dual &b) { return a /= b; }
+
+    friend Dual operator+(const Dual &a) { return a; }
+
+    friend Dual operator-(const Dual &a) {
+        return apply(a, -a.v, -1);
+    }
+
+    friend bool operator==(const Dual &a, const Dual &b) { return a.v == b.v; }
+    friend bool operator!=(const Dual &a, const Dual &b) { return a.v != b.v; }
+    friend bool operator<(const Dual &a, const Dual &b) { return a.v < b.v; }
+    friend bool operator<=(const Dual &a, const Dual &b) { return a.v <= b.v; }
+    friend bool operator>(const Dual &a, const Dual &b) { return a.v > b.v; }
+    friend bool operator>=(const Dual &a, const Dual &b) { return a.v >= b.v; }
+
+    friend Dual sqrt(const Dual &a) {
+        auto root = std::sqrt(a.v);
+        return apply(a, root, 0.5 / root);
+    }
+
+    friend Dual exp(const Dual &a) {
+        auto e = std::exp(a.v);
+        return apply(a, e, e);
+    }
+
+    friend Dual log(const Dual &a) { return apply(a, std::log(a.v), 1 / a.v); }
+    friend Dual sin(const Dual &a) { return apply(a, std::sin(a.v), std::cos(a.v)); }
+    friend Dual cos(const Dual &a) { return apply(a, std::cos(a.v), -std::sin(a.v)); }
+
+    friend Dual tan(const Dual &a) {
+        auto tangent = std::tan(a.v);
+        return apply(a, tangent, 1 + tangent * tangent);
+    }
+
+    friend Dual atan(const Dual &a) { return apply(a, std::atan(a.v), 1 / (1 + a.v * a.v)); }
+    friend Dual sinh(const Dual &a) { return apply(a, std::sinh(a.v), std::cosh(a.v)); }
+    friend Dual cosh(const Dual &a) { return apply(a, std::cosh(a.v), std::sinh(a.v)); }
+
+    friend Dual tanh(const Dual &a) {
+        auto tangent = std::tanh(a.v);
+        return apply(a, tangent, 1 - tangent * tangent);
+    }
+
+    friend Dual fabs(const Dual &a) { return apply(a, std::fabs(a.v), a.v < 0 ? -1 : 1); }
+    friend Dual abs(const Dual &a) { return fabs(a); }
+
+    friend Dual pow(const Dual &a, double b) {
+        // Written out for b = 2, the most common case, to avoid pow(0, 1) style corner cases in the derivative.
+        if (b == 2) return a * a;
+        return apply(a, std::pow(a.v, b), b * std::pow(a.v, b - 1));
+    }
+
+    friend Dual pow(double a, const Dual &b) {
+        auto power = std::pow(a, b.v);
+        return apply(b, power, power * std::log(a));
+    }
+
+    friend Dual pow(const Dual &a, const Dual &b) {
+        return exp(b * log(a));
+    }
+
+private:
+    // The chain rule: the result has value `value` and derivatives `slope` times those of `a`.
+    static Dual apply(const Dual &a, double value, double slope) {
+        Dual result(value);
+        for (std::size_t k = 0; k < N; k++) result.d[k] = slope * a.d[k];
+        return result;
+    }
+
+    double v;
+    std::array<double, N> d;
+};
+
+
+/**
+ * Computes the derivative of a scalar function `f(t, y)` with respect to `y` automatically.
+ *
+ * `f` must be callable with a `Dual<1>` in place of `y`, for example a generic lambda
+ * `[](double t, auto y) { return -y * y; }`.
+ *
+ * @param f the function `f`. The first argument corresponds to t and second to y.
+ * @return a function `fy(t, y)` returning the exact partial derivative of `f` with respect to `y`, suitable for the
+ *         scalar `backwardEulerMethod`.
+ */
+template <typename F>
+auto derivative(F f) {
+    return [f](double t, double y) {
+        return Dual<1>(f(t, Dual<1>(y, 0))).derivative();
+    };
+}
+
+#endif // CHAPTER_6_DUAL_H
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef CHAPTER_6_ENERGY_MONITOR_H
+#define CHAPTER_6_ENERGY_MONITOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+/**
+ * How far the energy of a conservative system strayed from its initial value during a run. Drifts are relative to
+ * the magnitude of the initial energy.
+ */
+struct EnergyDrift {
+    double initial = 0;
+    double final = 0;
+    // The largest relative deviation |E(t) - E(t0)| / |E(t0)| over all observed states.
+    double maxRelative = 0;
+    // The relative deviation of the final state, (E(t1) - E(t0)) / |E(t0)|, signed.
+    double finalRelative = 0;
+    long observed = 0;
+};
+
+
+/**
+ * An observer that tracks the energy of the states it receives, to check how well a solver conserves it. Pass it to
+ * the observer variant of any solver:
+ *
+ *      EnergyMonitor monitor([](const double *y) { return 0.5 * y[1] * y[1] - cos(y[0]); });
+ *      symplecticMethod<VELOCITY_VERLET_SCHEME>(a, y0, t0, t1, n, monitor);
+ *      auto drift = monitor.drift();
+ */
+template <typename Energy>
+class EnergyMonitor {
+public:
+    /**
+     * @param energy the energy of a state, called as `energy(y)`.
+     */
+    explicit EnergyMonitor(Energy energy) : energy(std::move(energy)) {}
+
+    void operator()(double t, const double *y) {
+        auto e = energy(y);
+        if (result.observed == 0) result.initial = e;
+        result.final = e;
+        result.finalRelative = (e - result.initial) / std::abs(result.initial);
+        result.maxRelative = std::max(result.maxRelative, std::abs(result.finalRelative));
+        result.observed++;
+    }
+
+    /**
+     * @return the drift over the states observed so far.
+     */
+    const EnergyDrift &drift() const {
+        return result;
+    }
+
+private:
+    Energy energy;
+    EnergyDrift result;
+};
+
+#endif // CHAPTER_6_ENERGY_MONITOR_H
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef CHAPTER_6_ENSEMBLE_METHOD_H
+#define CHAPTER_6_ENSEMBLE_METHOD_H
+
+#include <concepts>
+#include <cstddef>
+#include <vector>
+
+#include "RungeKuttaMethod.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
+#include "TrapezoidalMethod.h"
+
+enum EnsembleStatus {
+    ENSEMBLE_STATUS_OK = 0,
+    ENSEMBLE_STATUS_ERROR_DIMENSION_MISMATCH = 1
+};
+
+enum EnsembleScheme {
+    ENSEMBLE_SCHEME_TRAPEZOIDAL = 0,
+    ENSEMBLE_SCHEME_RUNGE_KUTTA = 1
+};
+
+/**
+ * The number of lanes is rounded up to a multiple of this, so that every loop over lanes is a whole number of AVX-512
+ * vectors (or two AVX2 vectors) with no scalar remainder. Padding lanes repeat the last ensemble member.
+ */
+constexpr std::size_t ENSEMBLE_LANE_WIDTH = 8;
+
+
+/**
+ * A system of ODEs evaluated for a whole ensemble at once, called as `f(t, y, dydt, lanes)`.
+ *
+ * States are stored lane-wise: component j of ensemble member l is `y[j * lanes + l]`, and `dydt` uses the same
+ * layout. Writing the body as a loop over `l` for each component, e.g.
+ *
+ *      for (std::size_t l = 0; l < lanes; l++) dydt[l] = y[lanes + l];
+ *
+ * gives the compiler contiguous, independent iterations that it vectorizes across the SIMD lanes.
+ */
+template <typename F>
+concept OdeEnsembleSystem = std::invocable<F &, double, const double *, double *, std::size_t>;
+
+
+/**
+ * Solves the same system of ODEs
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * from several initial conditions at once, advancing every member of the ensemble in lockstep with the same step
+ * size.
+ *
+ * The whole ensemble is treated as one lane-wise state of `m * lanes` entries, so the unmodified trapezoidal and
+ * Runge-Kutta steps run every stage update across all members in a single vectorizable loop, and `f` is called once
+ * per stage for the whole ensemble.
+ *
+ * @param scheme the method to use.
+ * @param f the ensemble system, called as `f(t, y, dydt, lanes)`.
+ * @param trajectories the trajectories to store the result of each member in (each must have the correct number of
+ *        time points, and there must be one per initial condition).
+ * @param y0 the initial condition vector of each member. All must have the same size, the dimension of the system.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the initial conditions have different sizes
+ *         or the number of trajectories does not match the number of initial conditions.
+ */
+template <OdeEnsembleSystem System>
+EnsembleStatus ensembleMethod(EnsembleScheme scheme, System &&f, std::vector<Trajectory> &trajectories,
+                              const std::vector<std::vector<double>> &y0, double t0, double t1,
+                              StepperWorkspace &workspace) {
+    if (y0.empty()) return ENSEMBLE_STATUS_OK;
+    if (trajectories.size() != y0.size()) return ENSEMBLE_STATUS_ERROR_DIMENSION_MISMATCH;
+    for (const auto &entry : y0) {
+        if (entry.size() != y0[0].size()) return ENSEMBLE_STATUS_ERROR_DIMENSION_MISMATCH;
+    }
+
+    // m is the number of systems, n is the number of time steps and members is the size of the ensemble.
+    auto m = y0[0].size();
+    auto n = (int) trajectories[0].size();
+    auto h = (t1 - t0) / (n - 1);
+    auto members = y0.size();
+    auto lanes = (members + ENSEMBLE_LANE_WIDTH - 1) / ENSEMBLE_LANE_WIDTH * ENSEMBLE_LANE_WIDTH;
+
+    // The lane-wise state is stored twice, for the current and next step, after the stepper's own buffers.
+    auto stages = scheme == ENSEMBLE_SCHEME_TRAPEZOIDAL ? TRAPEZOIDAL_STAGES : RUNGE_KUTTA_STAGES;
+    workspace.resize(m * lanes, stages + 2);
+    auto y = workspace.stage(stages);
+    auto yNext = workspace.stage(stages + 1);
+
+    auto system = [&](double t, const double *state, double *dydt) { f(t, state, dydt, lanes); };
+
+    // Gather the initial conditions into lanes, padding with copies of the last member.
+    for (auto j = 0; j < m; j++) {
+        for (auto l = 0; l < lanes; l++) {
+            y[j * lanes + l] = y0[std::min<std::size_t>(l, members - 1)][j];
+        }
+    }
+
+    for (auto &trajectory : trajectories) {
+        trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+        trajectory.resize(n, m);
+    }
+
+    auto t = t0;
+    for (auto i = 0; i < n; i++) {
+        // Scatter the current state to each member's trajectory.
+        for (auto l = 0; l < members; l++) {
+            trajectories[l].time(i) = t;
+            auto row = trajectories[l].row(i);
+            for (auto j = 0; j < m; j++) {
+                row[j] = y[j * lanes + l];
+            }
+        }
+        if (i == n - 1) break;
+
+        if (scheme == ENSEMBLE_SCHEME_TRAPEZOIDAL) {
+            trapezoidalStep(system, m * lanes, t, y, h, yNext, workspace);
+        }
+        else {
+            rungeKuttaStep(system, m * lanes, t, y, h, yNext, workspace);
+        }
+        std::swap(y, yNext);
+        t += h;
+    }
+
+    return ENSEMBLE_STATUS_OK;
+}
+
+
+/**
+ * Solves the same system of ODEs from several initial conditions at once, using a temporary workspace.
+ *
+ * @param scheme the method to use.
+ * @param f the ensemble system, called as `f(t, y, dydt, lanes)`.
+ * @param trajectories the trajectories to store the result of each member in (each must have the correct number of
+ *        time points, and there must be one per initial condition).
+ * @param y0 the initial condition vector of each member. All must have the same size, the dimension of the system.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the initial conditions have different sizes
+ *         or the number of trajectories does not match the number of initial conditions.
+ */
+template <OdeEnsembleSystem System>
+EnsembleStatus ensembleMethod(EnsembleScheme scheme, System &&f, std::vector<Trajectory> &trajectories,
+                              const std::vector<std::vector<double>> &y0, double t0, double t1) {
+    StepperWorkspace workspace;
+    return ensembleMethod(scheme, f, trajectories, y0, t0, t1, workspace);
+}
+
+#endif // CHAPTER_6_ENSEMBLE_METHOD_H
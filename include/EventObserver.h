@@ -0,0 +1,250 @@
+#pragma once
+#ifndef CHAPTER_6_EVENT_OBSERVER_H
+#define CHAPTER_6_EVENT_OBSERVER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "Observer.h"
+#include "OdeSystem.h"
+
+enum EventAction {
+    // Log the event and carry on.
+    EVENT_ACTION_CONTINUE = 0,
+    // Log the event, pass its state to the observer as an extra state and carry on.
+    EVENT_ACTION_RECORD = 1,
+    // Log the event, pass its state to the observer as the final state and stop the integration.
+    EVENT_ACTION_TERMINATE = 2
+};
+
+enum EventDirection {
+    EVENT_DIRECTION_ANY = 0,
+    // g goes from negative to non-negative.
+    EVENT_DIRECTION_RISING = 1,
+    // g goes from positive to non-positive.
+    EVENT_DIRECTION_FALLING = -1
+};
+
+
+/**
+ * An event happens where the event function `g(t, y)` changes sign along the solution, for example:
+ *
+ *      g = I'               the peak of the infected in the SIR model (falling)
+ *      g = I - threshold    the infected dropping below a threshold (falling)
+ *      g = theta            the zero crossings of a pendulum
+ *      g = sx vx + sy vy    the periapsis of an orbit, where the radius stops shrinking (rising)
+ */
+struct Event {
+    std::function<double(double t, const double *y)> g;
+    EventAction action = EVENT_ACTION_CONTINUE;
+    EventDirection direction = EVENT_DIRECTION_ANY;
+};
+
+
+/**
+ * A located event: the index of the event, and the time and state at which its function is zero.
+ */
+struct EventOccurrence {
+    std::size_t event;
+    double t;
+    std::vector<double> y;
+};
+
+
+/**
+ * An observer that watches the solution for events and forwards the states to another observer. Pass it to the
+ * observer variant of any solver with `every` set to 1, so it sees every step:
+ *
+ *      EventObserver watcher(f, m, {{peak, EVENT_ACTION_TERMINATE, EVENT_DIRECTION_FALLING}},
+ *                            TrajectoryRecorder(trajectory, m));
+ *      rungeKuttaMethod(f, y0, t0, t1, n, watcher);
+ *      watcher.occurrences();
+ *
+ * After each step the event functions are evaluated at the new state. If one changed sign, the solution over the step
+ * is approximated by the cubic Hermite interpolant of the two states and their slopes, and the root of g along it is
+ * found by the Illinois method. The slopes cost two evaluations of `f`, but only for steps that contain an event.
+ *
+ * Events within a step are handled in the order they happen. A terminating event ends the integration at the event
+ * time: its state is the last one the wrapped observer receives, and the solver stops without taking further steps.
+ */
+template <OdeSystem System, SolverObserver Observer>
+class EventObserver {
+public:
+    /**
+     * @param f the system, called as `f(t, y, dydt)`.
+     * @param dimension the dimension of the system.
+     * @param events the events to watch for.
+     * @param observer the observer to forward the states (and recorded events) to.
+     */
+    EventObserver(System f, std::size_t dimension, std::vector<Event> events, Observer observer)
+            : f(std::move(f)), m(dimension), events(std::move(events)), observer(std::move(observer)),
+              values(this->events.size()), yPrevious(m), fPrevious(m), fCurrent(m), yEvent(m) {}
+
+    bool operator()(double t, const double *y) {
+        tCurrent = t;
+        if (!started) {
+            started = true;
+            for (auto e = 0; e < events.size(); e++) {
+                values[e] = events[e].g(t, y);
+            }
+            remember(t, y);
+            return observe(observer, t, y);
+        }
+
+        // Locate every event whose function changed sign over the step.
+        pending.clear();
+        for (std::size_t e = 0; e < events.size(); e++) {
+            auto value = events[e].g(t, y);
+            if (crosses(events[e].direction, values[e], value)) {
+                if (pending.empty()) {
+                    if (!slopeKnown) f(tPrevious, yPrevious.data(), fPrevious.data());
+                    f(t, y, fCurrent.data());
+                }
+                pending.push_back({e, locate(events[e].g, values[e], value, y)});
+            }
+            values[e] = value;
+        }
+
+        std::sort(pending.begin(), pending.end(), [](auto &a, auto &b) { return a.t < b.t; });
+        for (auto &event : pending) {
+            interpolate(event.t, y, yEvent.data());
+            log.push_back({event.event, event.t, yEvent});
+
+            auto action = events[event.event].action;
+            if (action == EVENT_ACTION_TERMINATE) {
+                observe(observer, event.t, yEvent.data());
+                terminated = true;
+                return false;
+            }
+            if (action == EVENT_ACTION_RECORD && !observe(observer, event.t, yEvent.data())) return false;
+        }
+
+        // The slope at the new state is the slope at the start of the next step.
+        slopeKnown = !pending.empty();
+        if (slopeKnown) std::swap(fPrevious, fCurrent);
+        remember(t, y);
+        return observe(observer, t, y);
+    }
+
+    /**
+     * @return the events located so far, in the order they happened.
+     */
+    const std::vector<EventOccurrence> &occurrences() const {
+        return log;
+    }
+
+    /**
+     * @return whether a terminating event stopped the integration.
+     */
+    bool wasTerminated() const {
+        return terminated;
+    }
+
+private:
+    struct Pending {
+        std::size_t event;
+        double t;
+    };
+
+    static bool crosses(EventDirection direction, double before, double after) {
+        auto rising = before < 0 && after >= 0;
+        auto falling = before > 0 && after <= 0;
+        return direction == EVENT_DIRECTION_RISING ? rising : direction == EVENT_DIRECTION_FALLING ? falling
+                                                                                                   : rising || falling;
+    }
+
+    void remember(double t, const double *y) {
+        tPrevious = t;
+        std::copy(y, y + m, yPrevious.begin());
+    }
+
+    /**
+     * Evaluates the cubic Hermite interpolant of the last step at time `t`.
+     * @param y the state at the end of the step.
+     * @param result the array to store the interpolated state in.
+     */
+    void interpolate(double t, const double *y, double *result) const {
+        auto h = tCurrent - tPrevious;
+        auto s = (t - tPrevious) / h;
+        auto h00 = (1 + 2 * s) * (1 - s) * (1 - s);
+        auto h10 = s * (1 - s) * (1 - s);
+        auto h01 = s * s * (3 - 2 * s);
+        auto h11 = s * s * (s - 1);
+        for (auto j = 0; j < m; j++) {
+            result[j] = h00 * yPrevious[j] + h10 * h * fPrevious[j] + h01 * y[j] + h11 * h * fCurrent[j];
+        }
+    }
+
+    /**
+     * Finds the root of g along the interpolant of the last step with the Illinois variant of regula falsi, which
+     * keeps the root bracketed and converges superlinearly.
+     * @param gA the value of g at the start of the step.
+     * @param gB the value of g at the end of the step.
+     * @param y the state at the end of the step.
+     * @return the time of the root.
+     */
+    double locate(const std::function<double(double, const double *)> &g, double gA, double gB, const double *y) {
+        const auto maxIterations = 100;
+
+        auto a = tPrevious;
+        auto b = tCurrent;
+        if (gB == 0) return b;
+
+        auto tolerance = 4 * std::numeric_limits<double>::epsilon() * std::max(std::fabs(a), std::fabs(b));
+        auto root = b;
+        auto side = 0;
+        for (auto i = 0; i < maxIterations && b - a > tolerance; i++) {
+            auto c = std::clamp((a * gB - b * gA) / (gB - gA), a, b);
+            auto converged = std::fabs(c - root) <= tolerance;
+            root = c;
+            if (converged) break;
+
+            interpolate(c, y, yEvent.data());
+            auto gC = g(c, yEvent.data());
+            if (gC == 0) break;
+
+            if ((gC < 0) == (gB < 0)) {
+                b = c;
+                gB = gC;
+                // The same end moved twice in a row: halve the value kept at the other end to avoid stalling.
+                if (side == 1) gA /= 2;
+                side = 1;
+            }
+            else {
+                a = c;
+                gA = gC;
+                if (side == -1) gB /= 2;
+                side = -1;
+            }
+        }
+        return root;
+    }
+
+    System f;
+    std::size_t m;
+    std::vector<Event> events;
+    Observer observer;
+
+    // The event function values at the last state.
+    std::vector<double> values;
+
+    // The last state, and the slopes at both ends of the current step.
+    bool started = false;
+    bool slopeKnown = false;
+    double tPrevious = 0;
+    double tCurrent = 0;
+    std::vector<double> yPrevious;
+    std::vector<double> fPrevious;
+    std::vector<double> fCurrent;
+    std::vector<double> yEvent;
+
+    std::vector<Pending> pending;
+    std::vector<EventOccurrence> log;
+    bool terminated = false;
+};
+
+#endif // CHAPTER_6_EVENT_OBSERVER_H
@@ -0,0 +1,119 @@
+#pragma once
+#ifndef CHAPTER_6_EXPRESSION_SYSTEM_H
+#define CHAPTER_6_EXPRESSION_SYSTEM_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "OdeSystem.h"
+
+enum ExpressionStatus {
+    EXPRESSION_STATUS_OK = 0,
+    EXPRESSION_STATUS_ERROR_PARSE_FAILED = 1
+};
+
+
+/**
+ * A system of ODEs whose right-hand sides are given as exprtk expression strings of `t` and the vector `y`.
+ *
+ * Each expression is parsed exactly once by `compile`. The variables `t` and `y` are bound by reference to storage
+ * owned by the system, so evaluating a component only copies the arguments into that storage and calls
+ * `expression.value()`.
+ *
+ * For evaluating the whole system, the expressions are also fused into a single program (see `fuseExpressions`) that
+ * computes every shared subexpression once and writes all components in one pass. The program is only used if it
+ * compiles and agrees with the individual expressions at a few probe points.
+ *
+ * The functions returned by `functions` refer to this object, so it must outlive them. For the same reason the
+ * system can be neither copied nor moved.
+ */
+class ExpressionSystem {
+public:
+    ExpressionSystem();
+    ~ExpressionSystem();
+
+    ExpressionSystem(const ExpressionSystem &) = delete;
+    ExpressionSystem &operator=(const ExpressionSystem &) = delete;
+
+    /**
+     * Parse and compile the expressions {f1, ..., fn}. Any previously compiled expressions are discarded.
+     * @param expressions the expression strings, one per component.
+     * @return EXPRESSION_STATUS_OK if every expression compiles, EXPRESSION_STATUS_ERROR_PARSE_FAILED otherwise (see
+     *         `error` for the reason).
+     */
+    ExpressionStatus compile(const std::vector<std::string> &expressions);
+
+    /**
+     * @return a description of the last compilation error, or an empty string if there was none.
+     */
+    const std::string &error() const;
+
+    /**
+     * @return the number of components in the system.
+     */
+    std::size_t size() const;
+
+    /**
+     * Evaluate a single component of the system.
+     * @param index the index of the component.
+     * @param t the time.
+     * @param y the state vector (must have `size()` entries).
+     * @return the value of component `index` at (t, y).
+     */
+    double evaluate(std::size_t index, double t, const std::vector<double> &y);
+
+    /**
+     * Evaluate the whole system, copying the state into the bound storage only once.
+     * @param t the time.
+     * @param y the state (must have `size()` entries).
+     * @param dydt the array to store the value of every component in.
+     */
+    void operator()(double t, const double *y, double *dydt);
+
+    /**
+     * @return the fused program used by `operator()`, or an empty string if the components are evaluated one by one
+     *         because the expressions could not be fused.
+     */
+    const std::string &program() const;
+
+    /**
+     * @return the vector of functions {f1, ..., fn}, suitable for `trapezoidalMethod` and `rungeKuttaMethod`.
+     */
+    std::vector<funcn> functions();
+
+private:
+    /**
+     * Check the fused program against the individual expressions at a few arbitrary points. Hoisting does not change
+     * the arithmetic, so the results must agree up to rounding, and be NaN for the same components.
+     * @return whether they agree at every point.
+     */
+    bool fusedMatches();
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+
+/**
+ * Fuse the expressions {f1, ..., fn} into a single exprtk program that assigns every component to the vector `output`:
+ *
+ *      var cse_0 := sqrt(y[0]^2 + y[1]^2);
+ *      output[0] := (-y[0] / cse_0^3);
+ *      output[1] := (-y[1] / cse_0^3);
+ *
+ * Function calls and parenthesized subexpressions that occur more than once (in the same or in different components)
+ * are hoisted into local variables, innermost first, so each is computed once per evaluation. Only these explicitly
+ * delimited subexpressions are shared, so the way exprtk parses the rest of each expression is unchanged.
+ * Subexpressions that refer to the state vector `y` as a whole or to a range of it, such as `sum(y)` or `(y + 1)`,
+ * are never hoisted, since they may be vectors themselves.
+ *
+ * @param expressions the expression strings, one per component.
+ * @param output the name of the vector to assign the components to.
+ * @return the fused program, or an empty string if an expression uses statements, assignments, strings or comments
+ *         and so cannot be fused.
+ */
+std::string fuseExpressions(const std::vector<std::string> &expressions, const std::string &output);
+
+#endif // CHAPTER_6_EXPRESSION_SYSTEM_H
@@ -0,0 +1,155 @@
+#pragma once
+#ifndef CHAPTER_6_ITERATION_MATRIX_H
+#define CHAPTER_6_ITERATION_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+
+#include "LinearAlgebra.h"
+
+
+/**
+ * The iteration matrix I - h J of Newton's method for an implicit step, with a dense Jacobian: `fy(t, y, jacobian)`
+ * fills the m x m row-major array `jacobian`. Factoring it takes O(m^3) work and O(m^2) storage, so this suits small
+ * systems only.
+ */
+class DenseIterationMatrix {
+public:
+    /**
+     * Size the storage for a system of dimension `m`.
+     * @return STATUS_OK.
+     */
+    LinearAlgebraStatus resize(std::size_t m);
+
+    /**
+     * @return the number of entries of the Jacobian array, m * m.
+     */
+    std::size_t jacobianSize() const;
+
+    /**
+     * Form I - h J and factor it.
+     * @param h the step size.
+     * @param jacobian the Jacobian.
+     * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if the matrix is singular.
+     */
+    LinearAlgebraStatus factor(double h, const double *jacobian);
+
+    /**
+     * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+     */
+    void solve(double *b) const;
+
+private:
+    std::size_t m = 0;
+    std::vector<double> lu;
+    std::vector<std::size_t> pivots;
+};
+
+
+/**
+ * The iteration matrix I - h J of Newton's method for an implicit step, with a banded Jacobian, such as that of a
+ * one-dimensional method-of-lines discretization: `fy(t, y, jacobian)` fills the `lower + upper + 1` entries of each
+ * row, with the partial derivative of yi' with respect to yj at
+ *
+ *      jacobian[i * (lower + upper + 1) + lower + j - i]
+ *
+ * for i - lower <= j <= i + upper. Entries for j outside the matrix are ignored. Factoring it with `bandedLuFactor`
+ * takes O(m lower (lower + upper)) work and O(m (2 lower + upper)) storage.
+ */
+class BandedIterationMatrix {
+public:
+    /**
+     * @param lower the number of subdiagonals of the Jacobian.
+     * @param upper the number of superdiagonals of the Jacobian.
+     */
+    BandedIterationMatrix(std::size_t lower, std::size_t upper);
+
+    /**
+     * Size the storage for a system of dimension `m`.
+     * @return STATUS_OK.
+     */
+    LinearAlgebraStatus resize(std::size_t m);
+
+    /**
+     * @return the number of entries of the Jacobian array, m * (lower + upper + 1).
+     */
+    std::size_t jacobianSize() const;
+
+    /**
+     * Form I - h J and factor it.
+     * @param h the step size.
+     * @param jacobian the Jacobian.
+     * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if the matrix is singular.
+     */
+    LinearAlgebraStatus factor(double h, const double *jacobian);
+
+    /**
+     * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+     */
+    void solve(double *b) const;
+
+private:
+    std::size_t lower;
+    std::size_t upper;
+    std::size_t m = 0;
+    std::vector<double> lu;
+    std::vector<std::size_t> pivots;
+};
+
+
+/**
+ * The iteration matrix I - h J of Newton's method for an implicit step, with a sparse Jacobian of fixed pattern:
+ * `fy(t, y, jacobian)` fills `jacobian[p]` with the partial derivative for the p-th entry of the pattern. Entries
+ * outside the pattern are zero.
+ *
+ * The pattern of the LU factors is computed once, on construction (see `sparseLuAnalyze`), and every factorization
+ * only redoes the numeric part. Work and storage are proportional to the number of entries of the factors, which is
+ * O(m) for banded patterns in any ordering and for patterns whose few entries outside a band are in the last rows and
+ * columns, such as those of periodic boundary conditions. The factorization does not pivot; see `sparseLuFactor`.
+ */
+class SparseIterationMatrix {
+public:
+    /**
+     * @param pattern the pattern of the Jacobian, checked by `sparseLuAnalyze`. If it is invalid, `status` says so
+     *        and `resize` fails.
+     */
+    explicit SparseIterationMatrix(SparsePattern pattern);
+
+    /**
+     * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise.
+     */
+    LinearAlgebraStatus status() const;
+
+    /**
+     * Size the storage for a system of dimension `m`.
+     * @return STATUS_OK, or STATUS_ERROR_INVALID_PATTERN if the pattern is invalid or not of dimension `m`.
+     */
+    LinearAlgebraStatus resize(std::size_t m);
+
+    /**
+     * @return the number of entries of the Jacobian array, that of the pattern.
+     */
+    std::size_t jacobianSize() const;
+
+    /**
+     * Form I - h J and factor it.
+     * @param h the step size.
+     * @param jacobian the Jacobian.
+     * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+     */
+    LinearAlgebraStatus factor(double h, const double *jacobian);
+
+    /**
+     * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+     */
+    void solve(double *b) const;
+
+private:
+    SparsePattern pattern;
+    SparseLuSymbolic symbolic;
+    LinearAlgebraStatus analysis;
+    std::vector<double> lu;
+    std::vector<std::size_t> work;
+};
+
+#endif // CHAPTER_6_ITERATION_MATRIX_H
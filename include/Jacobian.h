@@ -0,0 +1,359 @@
+#pragma once
+#ifndef CHAPTER_6_JACOBIAN_H
+#define CHAPTER_6_JACOBIAN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Dual.h"
+#include "LinearAlgebra.h"
+#include "OdeSystem.h"
+
+
+/**
+ * Computes the Jacobian of a system exactly by forward-mode automatic differentiation.
+ *
+ * The system must be written once for a generic scalar type, for example
+ *
+ *      auto f = [](double t, const auto *y, auto *dydt) { dydt[0] = y[1]; dydt[1] = -sin(y[0]); };
+ *
+ * and is then usable both as an `OdeSystem` (with `double`) and, wrapped in this class, as an `OdeJacobian`. Each
+ * evaluation seeds `N` state components at a time, so the full Jacobian of an m-dimensional system costs
+ * ceil(m / N) evaluations of `f` with `Dual<N>` arguments.
+ */
+template <typename F, std::size_t N = 4>
+class AutomaticJacobian {
+public:
+    /**
+     * @param f the generic system.
+     * @param m the dimension of the system.
+     */
+    AutomaticJacobian(F f, std::size_t m) : f(f), m(m), y(m), dydt(m) {}
+
+    /**
+     * Fill the m x m row-major `jacobian` with the partial derivatives of `f` at (t, state).
+     */
+    void operator()(double t, const double *state, double *jacobian) {
+        for (std::size_t first = 0; first < m; first += N) {
+            // Seed the next block of (up to) N components as the independent variables.
+            for (std::size_t j = 0; j < m; j++) {
+                y[j] = (j >= first && j < first + N) ? Dual<N>(state[j], j - first) : Dual<N>(state[j]);
+            }
+
+            f(t, static_cast<const Dual<N> *>(y.data()), dydt.data());
+
+            auto count = std::min(N, m - first);
+            for (std::size_t i = 0; i < m; i++) {
+                for (std::size_t k = 0; k < count; k++) {
+                    jacobian[i * m + first + k] = dydt[i].derivative(k);
+                }
+            }
+        }
+    }
+
+private:
+    F f;
+    std::size_t m;
+    std::vector<Dual<N>> y;
+    std::vector<Dual<N>> dydt;
+};
+
+
+/**
+ * Groups the columns of a Jacobian with the given sparsity pattern so that no two columns in a group have a nonzero
+ * in the same row. The columns of a group can be approximated together with a single evaluation of the system.
+ * @param pattern the m x m row-major sparsity pattern, true where fi depends on yj.
+ * @param m the dimension of the system.
+ * @param colors array of `m` entries to store the group of each column in.
+ * @return the number of groups.
+ */
+std::size_t colorJacobianColumns(const std::vector<bool> &pattern, std::size_t m, std::size_t *colors);
+
+/**
+ * Groups the columns of a Jacobian with the given sparse pattern so that no two columns in a group have a nonzero in
+ * the same row, in time proportional to the sum over the rows of their squared number of entries.
+ * @param pattern the sparsity pattern, valid according to `checkSparsePattern`, with an entry where fi depends on yj.
+ * @param colors array of `pattern.m` entries to store the group of each column in.
+ * @return the number of groups.
+ */
+std::size_t colorJacobianColumns(const SparsePattern &pattern, std::size_t *colors);
+
+
+/**
+ * Approximates the dense Jacobian of an opaque system by forward differences, for `DenseIterationMatrix`. The
+ * pattern and the Jacobian take O(m^2) storage, so large systems should use `BandedFiniteDifferenceJacobian` or
+ * `SparseFiniteDifferenceJacobian` instead.
+ *
+ * Without a sparsity pattern every column costs one extra evaluation of `f`. When a pattern is given, structurally
+ * independent columns are perturbed together (see `colorJacobianColumns`), so a banded or block system needs only as
+ * many extra evaluations as there are column groups, independent of the dimension.
+ */
+template <OdeSystem F>
+class FiniteDifferenceJacobian {
+public:
+    /**
+     * @param f the system. It is referenced, not copied, so it must outlive this object.
+     * @param m the dimension of the system.
+     * @param pattern the m x m row-major sparsity pattern, true where fi depends on yj. Empty means dense.
+     */
+    FiniteDifferenceJacobian(F &f, std::size_t m, std::vector<bool> pattern = {})
+            : f(f), m(m), pattern(std::move(pattern)), colors(m), y(m), f0(m), f1(m), steps(m) {
+        if (this->pattern.empty()) {
+            this->pattern.assign(m * m, true);
+            for (std::size_t j = 0; j < m; j++) colors[j] = j;
+            groups = m;
+        }
+        else {
+            groups = colorJacobianColumns(this->pattern, m, colors.data());
+        }
+    }
+
+    /**
+     * @return the number of extra evaluations of `f` per Jacobian, besides the one at the unperturbed state.
+     */
+    std::size_t evaluations() const {
+        return groups;
+    }
+
+    /**
+     * Fill the m x m row-major `jacobian` with a forward difference approximation at (t, state).
+     */
+    void operator()(double t, const double *state, double *jacobian) {
+        std::fill(jacobian, jacobian + m * m, 0.0);
+        f(t, state, f0.data());
+
+        for (std::size_t group = 0; group < groups; group++) {
+            // Perturb every column in the group at once.
+            std::copy(state, state + m, y.begin());
+            for (std::size_t j = 0; j < m; j++) {
+                if (colors[j] != group) continue;
+                steps[j] = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(std::fabs(state[j]), 1.0);
+                y[j] = state[j] + steps[j];
+                steps[j] = y[j] - state[j];     // The step that was actually representable.
+            }
+
+            f(t, y.data(), f1.data());
+
+            // Each row that changed belongs to the single column of the group it depends on.
+            for (std::size_t j = 0; j < m; j++) {
+                if (colors[j] != group) continue;
+                for (std::size_t i = 0; i < m; i++) {
+                    if (pattern[i * m + j]) jacobian[i * m + j] = (f1[i] - f0[i]) / steps[j];
+                }
+            }
+        }
+    }
+
+private:
+    F &f;
+    std::size_t m;
+    std::vector<bool> pattern;
+    std::vector<std::size_t> colors;
+    std::size_t groups = 0;
+    std::vector<double> y;
+    std::vector<double> f0;
+    std::vector<double> f1;
+    std::vector<double> steps;
+};
+
+
+/**
+ * Approximates the banded Jacobian of an opaque system by forward differences, in the layout of
+ * `BandedIterationMatrix`: the partial derivative of yi' with respect to yj at
+ *
+ *      jacobian[i * (lower + upper + 1) + lower + j - i]
+ *
+ * Columns that are `lower + upper + 1` apart never share a row, so they are perturbed together and each Jacobian costs
+ * `lower + upper + 1` extra evaluations of `f` whatever the dimension.
+ */
+template <OdeSystem F>
+class BandedFiniteDifferenceJacobian {
+public:
+    /**
+     * @param f the system. It is referenced, not copied, so it must outlive this object.
+     * @param m the dimension of the system.
+     * @param lower the number of subdiagonals of the Jacobian.
+     * @param upper the number of superdiagonals of the Jacobian.
+     */
+    BandedFiniteDifferenceJacobian(F &f, std::size_t m, std::size_t lower, std::size_t upper)
+            : f(f), m(m), lower(lower), upper(upper), groups(std::min(m, lower + upper + 1)), y(m), f0(m), f1(m),
+              steps(m) {}
+
+    /**
+     * @return the number of extra evaluations of `f` per Jacobian, besides the one at the unperturbed state.
+     */
+    std::size_t evaluations() const {
+        return groups;
+    }
+
+    /**
+     * Fill the m x (lower + upper + 1) `jacobian` with a forward difference approximation at (t, state). Entries
+     * outside the matrix are set to zero.
+     */
+    void operator()(double t, const double *state, double *jacobian) {
+        auto width = lower + upper + 1;
+        std::fill(jacobian, jacobian + m * width, 0.0);
+        f(t, state, f0.data());
+        std::copy(state, state + m, y.begin());
+
+        for (std::size_t group = 0; group < groups; group++) {
+            // Perturb every column in the group at once.
+            for (auto j = group; j < m; j += width) {
+                steps[j] = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(std::fabs(state[j]), 1.0);
+                y[j] = state[j] + steps[j];
+                steps[j] = y[j] - state[j];     // The step that was actually representable.
+            }
+
+            f(t, y.data(), f1.data());
+
+            // Column j reaches rows j - upper, ..., j + lower, which no other column of the group does.
+            for (auto j = group; j < m; j += width) {
+                auto first = j > upper ? j - upper : 0;
+                auto last = std::min(m - 1, j + lower);
+                for (auto i = first; i <= last; i++) {
+                    jacobian[i * width + lower + j - i] = (f1[i] - f0[i]) / steps[j];
+                }
+                y[j] = state[j];
+            }
+        }
+    }
+
+private:
+    F &f;
+    std::size_t m;
+    std::size_t lower;
+    std::size_t upper;
+    std::size_t groups;
+    std::vector<double> y;
+    std::vector<double> f0;
+    std::vector<double> f1;
+    std::vector<double> steps;
+};
+
+
+/**
+ * Approximates the sparse Jacobian of an opaque system by forward differences, in the layout of
+ * `SparseIterationMatrix`: `jacobian[p]` is the partial derivative for the p-th entry of the pattern.
+ *
+ * Structurally independent columns are perturbed together (see `colorJacobianColumns`), so each Jacobian costs as
+ * many extra evaluations of `f` as there are column groups, which for the stencils of method-of-lines discretizations
+ * does not grow with the dimension. Storage is proportional to the number of entries of the pattern.
+ */
+template <OdeSystem F>
+class SparseFiniteDifferenceJacobian {
+public:
+    /**
+     * @param f the system. It is referenced, not copied, so it must outlive this object.
+     * @param pattern the sparsity pattern, with an entry where fi depends on yj. If it is invalid (see
+     *        `checkSparsePattern`), `status` says so and the Jacobian is left untouched.
+     */
+    SparseFiniteDifferenceJacobian(F &f, const SparsePattern &pattern)
+            : f(f), m(pattern.m), analysis(checkSparsePattern(pattern)) {
+        if (analysis != LINEAR_ALGEBRA_STATUS_OK) return;
+
+        // The entries of each column, with their rows and positions in the pattern.
+        columnStart.assign(m + 1, 0);
+        for (auto j : pattern.columns) {
+            columnStart[j + 1]++;
+        }
+        for (std::size_t j = 0; j < m; j++) {
+            columnStart[j + 1] += columnStart[j];
+        }
+        rows.resize(pattern.nonzeros());
+        positions.resize(pattern.nonzeros());
+        std::vector<std::size_t> next(columnStart.begin(), columnStart.end() - 1);
+        for (std::size_t i = 0; i < m; i++) {
+            for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1]; p++) {
+                auto q = next[pattern.columns[p]]++;
+                rows[q] = i;
+                positions[q] = p;
+            }
+        }
+
+        // The columns of each group.
+        std::vector<std::size_t> colors(m);
+        auto groups = colorJacobianColumns(pattern, colors.data());
+        groupStart.assign(groups + 1, 0);
+        for (auto color : colors) {
+            groupStart[color + 1]++;
+        }
+        for (std::size_t group = 0; group < groups; group++) {
+            groupStart[group + 1] += groupStart[group];
+        }
+        groupColumns.resize(m);
+        next.assign(groupStart.begin(), groupStart.end() - 1);
+        for (std::size_t j = 0; j < m; j++) {
+            groupColumns[next[colors[j]]++] = j;
+        }
+
+        y.resize(m);
+        f0.resize(m);
+        f1.resize(m);
+        steps.resize(m);
+    }
+
+    /**
+     * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise.
+     */
+    LinearAlgebraStatus status() const {
+        return analysis;
+    }
+
+    /**
+     * @return the number of extra evaluations of `f` per Jacobian, besides the one at the unperturbed state.
+     */
+    std::size_t evaluations() const {
+        return groupStart.empty() ? 0 : groupStart.size() - 1;
+    }
+
+    /**
+     * Fill `jacobian`, one value per entry of the pattern, with a forward difference approximation at (t, state).
+     */
+    void operator()(double t, const double *state, double *jacobian) {
+        if (analysis != LINEAR_ALGEBRA_STATUS_OK) return;
+
+        f(t, state, f0.data());
+        std::copy(state, state + m, y.begin());
+
+        for (std::size_t group = 0; group < evaluations(); group++) {
+            // Perturb every column in the group at once.
+            for (auto k = groupStart[group]; k < groupStart[group + 1]; k++) {
+                auto j = groupColumns[k];
+                steps[j] = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(std::fabs(state[j]), 1.0);
+                y[j] = state[j] + steps[j];
+                steps[j] = y[j] - state[j];     // The step that was actually representable.
+            }
+
+            f(t, y.data(), f1.data());
+
+            // Each row that changed belongs to the single column of the group it depends on.
+            for (auto k = groupStart[group]; k < groupStart[group + 1]; k++) {
+                auto j = groupColumns[k];
+                for (auto q = columnStart[j]; q < columnStart[j + 1]; q++) {
+                    jacobian[positions[q]] = (f1[rows[q]] - f0[rows[q]]) / steps[j];
+                }
+                y[j] = state[j];
+            }
+        }
+    }
+
+private:
+    F &f;
+    std::size_t m;
+    LinearAlgebraStatus analysis;
+    std::vector<std::size_t> columnStart;
+    std::vector<std::size_t> rows;
+    std::vector<std::size_t> positions;
+    std::vector<std::size_t> groupStart;
+    std::vector<std::size_t> groupColumns;
+    std::vector<double> y;
+    std::vector<double> f0;
+    std::vector<double> f1;
+    std::vector<double> steps;
+};
+
+#endif // CHAPTER_6_JACOBIAN_H
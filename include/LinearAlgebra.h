@@ -0,0 +1,156 @@
+#pragma once
+#ifndef CHAPTER_6_LINEAR_ALGEBRA_H
+#define CHAPTER_6_LINEAR_ALGEBRA_H
+
+#include <cstddef>
+#include <vector>
+
+enum LinearAlgebraStatus {
+    LINEAR_ALGEBRA_STATUS_OK = 0,
+    LINEAR_ALGEBRA_STATUS_ERROR_SINGULAR_MATRIX = 1,
+    LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN = 2
+};
+
+
+/**
+ * Computes the LU factorization of a dense square matrix in place, using partial pivoting:
+ *
+ *      P A = L U
+ *
+ * @param a the m x m matrix in row-major order. It is overwritten by U (on and above the diagonal) and the
+ *        multipliers of L (below the diagonal, whose diagonal is implicitly 1).
+ * @param m the number of rows and columns.
+ * @param pivots array of `m` entries to store the row permutation in.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus luFactor(double *a, std::size_t m, std::size_t *pivots);
+
+/**
+ * Solves A x = b given the factorization computed by `luFactor`.
+ * @param lu the factored matrix.
+ * @param m the number of rows and columns.
+ * @param pivots the row permutation.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void luSolve(const double *lu, std::size_t m, const std::size_t *pivots, double *b);
+
+
+/**
+ * Computes the LU factorization of a banded square matrix in place, using partial pivoting. Only the band is stored
+ * and touched, so the work is O(m lower (lower + upper)) and the storage O(m (2 lower + upper)).
+ *
+ * The matrix is stored by columns with `2 lower + upper + 1` entries each, entry (i, j) at
+ *
+ *      ab[j * (2 lower + upper + 1) + lower + upper + i - j]
+ *
+ * for j - upper <= i <= j + lower. The first `lower` entries of each column are extra room for the fill-in from row
+ * interchanges and need not be initialized.
+ *
+ * @param ab the banded matrix, overwritten by U (whose upper bandwidth grows to lower + upper) and the multipliers
+ *        of L.
+ * @param m the number of rows and columns.
+ * @param lower the number of subdiagonals.
+ * @param upper the number of superdiagonals.
+ * @param pivots array of `m` entries to store the row interchanges in.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus bandedLuFactor(double *ab, std::size_t m, std::size_t lower, std::size_t upper,
+                                   std::size_t *pivots);
+
+/**
+ * Solves A x = b given the factorization computed by `bandedLuFactor`.
+ * @param lu the factored matrix.
+ * @param m the number of rows and columns.
+ * @param lower the number of subdiagonals.
+ * @param upper the number of superdiagonals.
+ * @param pivots the row interchanges.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void bandedLuSolve(const double *lu, std::size_t m, std::size_t lower, std::size_t upper, const std::size_t *pivots,
+                   double *b);
+
+
+/**
+ * The positions of the nonzero entries of an m x m sparse matrix in compressed sparse row (CSR) form: the entries of
+ * row i are `columns[rowStart[i]]`, ..., `columns[rowStart[i + 1] - 1]`. The values of such a matrix are stored
+ * separately, in the same order.
+ */
+struct SparsePattern {
+    std::size_t m = 0;
+    std::vector<std::size_t> rowStart;
+    std::vector<std::size_t> columns;
+
+    /**
+     * @return the number of stored entries.
+     */
+    std::size_t nonzeros() const {
+        return columns.size();
+    }
+};
+
+
+/**
+ * Checks that a sparse pattern is well formed: `m + 1` row starts, from 0 to the number of entries and nondecreasing,
+ * and the columns of each row strictly increasing and less than `m`.
+ * @param pattern the pattern to check.
+ * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise.
+ */
+LinearAlgebraStatus checkSparsePattern(const SparsePattern &pattern);
+
+
+/**
+ * The result of `sparseLuAnalyze`: the pattern of the LU factors of a sparse matrix, including the fill-in, and where
+ * each entry of the matrix goes in it. It depends only on the pattern of the matrix, so it is computed once and reused
+ * for every matrix with that pattern.
+ */
+struct SparseLuSymbolic {
+    // The pattern of L and U together, each row sorted by column. L is left of the diagonal and U on and right of it.
+    SparsePattern factors;
+
+    // The index in `factors.columns` of the diagonal entry of each row.
+    std::vector<std::size_t> diagonal;
+
+    // The index in `factors.columns` of each entry of the analyzed pattern.
+    std::vector<std::size_t> positions;
+};
+
+
+/**
+ * Computes the pattern of the LU factors of a sparse matrix with the given pattern, factored without pivoting in the
+ * given order, and where each of its entries goes in them. The diagonal is always part of the factors, whether or not
+ * it is in the pattern.
+ *
+ * The fill-in depends on the ordering: for a matrix whose entries all lie within a band, the factors stay within the
+ * band, so number the unknowns to keep the bandwidth small.
+ *
+ * @param pattern the pattern of the matrix, checked by `checkSparsePattern`.
+ * @param symbolic the analysis to fill in.
+ * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise, leaving `symbolic` empty.
+ */
+LinearAlgebraStatus sparseLuAnalyze(const SparsePattern &pattern, SparseLuSymbolic &symbolic);
+
+/**
+ * Computes the LU factorization of a sparse matrix in place, without pivoting:
+ *
+ *      A = L U
+ *
+ * The pivots are the diagonal entries in the analyzed order, which is stable for diagonally dominant matrices such as
+ * the iteration matrix I - h J of small enough steps, but may fail or lose accuracy otherwise.
+ *
+ * @param symbolic the analysis of the matrix's pattern.
+ * @param lu the matrix, with `symbolic.factors.nonzeros()` entries in the order of `symbolic.factors` and zeros in the
+ *        fill-in. It is overwritten by U and the multipliers of L (whose diagonal is implicitly 1).
+ * @param work array of `symbolic.factors.m` entries of scratch storage.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus sparseLuFactor(const SparseLuSymbolic &symbolic, double *lu, std::size_t *work);
+
+/**
+ * Solves A x = b given the factorization computed by `sparseLuFactor`.
+ * @param symbolic the analysis of the matrix's pattern.
+ * @param lu the factored matrix.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void sparseLuSolve(const SparseLuSymbolic &symbolic, const double *lu, double *b);
+
+#endif // CHAPTER_6_LINEAR_ALGEBRA_H
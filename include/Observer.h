@@ -0,0 +1,161 @@
+#pragma once
+#ifndef CHAPTER_6_OBSERVER_H
+#define CHAPTER_6_OBSERVER_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Trajectory.h"
+
+
+/**
+ * Receives the solution as it is computed, called as `observer(t, y)` with the time and the state (of the system's
+ * dimension) of each observed step. `y` is only valid for the duration of the call.
+ *
+ * The observer variants of the solvers keep nothing but the current state, so their memory use does not grow with the
+ * number of steps.
+ *
+ * An observer may return `bool` instead of `void`: returning false stops the integration, making the state just
+ * observed the final one (see `EventObserver`).
+ */
+template <typename O>
+concept SolverObserver = std::invocable<O &, double, const double *>;
+
+/**
+ * A type-erased observer, for solvers that are not templates.
+ */
+using observern = std::function<void(double t, const double *y)>;
+
+/**
+ * Passing this as `every` to an observer variant of a solver only observes the final state.
+ */
+constexpr int OBSERVE_FINAL_STATE_ONLY = 0;
+
+
+/**
+ * Decides whether the step that produced state number `i` (0 is the initial condition) should be observed.
+ * @param i the index of the state.
+ * @param last whether this is the final state.
+ * @param every observe every `every`-th state, or only the final state for `OBSERVE_FINAL_STATE_ONLY`. The initial
+ *        and final states are always observed otherwise.
+ */
+inline bool shouldObserve(long i, bool last, int every) {
+    if (last) return true;
+    if (every == OBSERVE_FINAL_STATE_ONLY) return false;
+    return i % every == 0;
+}
+
+
+/**
+ * Passes a state to an observer.
+ * @return false if the observer asked to stop the integration.
+ */
+template <SolverObserver Observer>
+inline bool observe(Observer &observer, double t, const double *y) {
+    if constexpr (std::is_same_v<std::invoke_result_t<Observer &, double, const double *>, bool>) {
+        return observer(t, y);
+    }
+    else {
+        observer(t, y);
+        return true;
+    }
+}
+
+
+/**
+ * An observer that appends every state it receives to a `Trajectory`, for example to keep every 100th step of a long
+ * run.
+ */
+class TrajectoryRecorder {
+public:
+    /**
+     * @param trajectory the trajectory to append to. It is cleared and set up for the given dimension.
+     * @param dimension the dimension of the system.
+     * @param expected the number of states expected, reserved up front (optional).
+     */
+    TrajectoryRecorder(Trajectory &trajectory, std::size_t dimension, std::size_t expected = 0)
+            : trajectory(trajectory) {
+        trajectory.clear();
+        trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+        trajectory.resize(0, dimension);
+        trajectory.reserve(expected);
+    }
+
+    void operator()(double t, const double *y) {
+        trajectory.append(t, y);
+    }
+
+private:
+    Trajectory &trajectory;
+};
+
+
+/**
+ * The fixed-step loop shared by the observer variants of the explicit solvers, continuing from state number `first`
+ * up to state number `last`. Only two states are kept: the current one and the one being computed.
+ * @param step the single-step function, called as `step(t, y, h, yNext)`. Returning false stops the integration without
+ *        observing the failed step.
+ * @param t the time of state number `first`.
+ * @param h the step size.
+ * @param first the number of the state to start from. The initial state (0) is observed, any other was observed
+ *        before the integration was interrupted.
+ * @param last the number of the final state.
+ * @param observer the observer to pass the states to.
+ * @param every observe every `every`-th state, or only the final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param y storage for the current state, holding state number `first` on entry.
+ * @param yNext storage for the next state.
+ * @param after called as `after(i, t, y, final)` after state number `i` has been computed and observed, where `final`
+ *        tells whether the integration ends with it. Returning false stops the integration.
+ * @return false if `step` or `after` stopped the integration. Stopping at the request of the observer is not a failure.
+ */
+template <typename Step, SolverObserver Observer, typename After>
+bool integrateFixedSteps(Step &&step, double t, double h, long first, long last, Observer &observer, int every,
+                         double *y, double *yNext, After &&after) {
+    if (first == 0 && shouldObserve(0, last == 0, every) && !observe(observer, t, y)) return after(first, t, y, true);
+    if (first >= last) return after(first, t, y, true);
+
+    for (auto i = first; i < last; i++) {
+        if (!step(t, y, h, yNext)) return false;
+        t += h;
+        std::swap(y, yNext);
+
+        auto stop = shouldObserve(i + 1, i + 1 == last, every) && !observe(observer, t, y);
+        if (!after(i + 1, t, y, stop || i + 1 == last)) return false;
+        if (stop) break;
+    }
+
+    return true;
+}
+
+
+/**
+ * The fixed-step loop shared by the observer variants of the explicit solvers, from the initial conditions.
+ * @param step the single-step function, called as `step(t, y, h, yNext)`. Returning false stops the integration without
+ *        observing the failed step.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer to pass the states to.
+ * @param every observe every `every`-th state, or only the final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param y storage for the current state (`y0.size()` entries).
+ * @param yNext storage for the next state (`y0.size()` entries).
+ * @return false if `step` stopped the integration. Stopping at the request of the observer is not a failure.
+ */
+template <typename Step, SolverObserver Observer>
+bool integrateFixedSteps(Step &&step, const std::vector<double> &y0, double t0, double t1, int n, Observer &observer,
+                         int every, double *y, double *yNext) {
+    auto h = (t1 - t0) / (n - 1);
+
+    // Initial conditions.
+    std::copy(y0.begin(), y0.end(), y);
+    return integrateFixedSteps(step, t0, h, 0, n - 1, observer, every, y, yNext,
+                               [](long, double, const double *, bool) { return true; });
+}
+
+#endif // CHAPTER_6_OBSERVER_H
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef CHAPTER_6_ODE_SYSTEM_H
+#define CHAPTER_6_ODE_SYSTEM_H
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+using funcn = std::function<double(double t, const std::vector<double> &y)>;
+
+/**
+ * A whole system of ODEs, evaluated in one call. The arguments are the time `t`, the state `y` and the array `dydt`
+ * to fill with y1', ..., yn'. `y` and `dydt` both have n entries and never alias.
+ */
+using funcsys = std::function<void(double t, const double *y, double *dydt)>;
+
+/**
+ * Anything callable as `f(t, y, dydt)` with the same meaning as `funcsys`. Solvers that are templated on this concept
+ * can inline the right-hand side, which `funcsys` and `funcn` prevent.
+ */
+template <typename F>
+concept OdeSystem = std::invocable<F &, double, const double *, double *>;
+
+/**
+ * The Jacobian of a system of n ODEs, evaluated in one call. The arguments are the time `t`, the state `y` and the
+ * n x n row-major array `jacobian` to fill, where `jacobian[i * n + j]` is the partial derivative of yi' with respect
+ * to yj.
+ */
+using funcjac = std::function<void(double t, const double *y, double *jacobian)>;
+
+/**
+ * Anything callable as `fy(t, y, jacobian)` with the same meaning as `funcjac`.
+ */
+template <typename F>
+concept OdeJacobian = std::invocable<F &, double, const double *, double *>;
+
+
+/**
+ * Adapts a vector of functions {f1, ..., fn} to the whole-system interface so it can be passed to any solver that
+ * accepts an `OdeSystem`.
+ */
+class FunctionVectorSystem {
+public:
+    /**
+     * @param f the vector of functions {f1, ..., fn}. It is referenced, not copied, so it must outlive the adapter.
+     */
+    explicit FunctionVectorSystem(const std::vector<funcn> &f) : f(f), state(f.size()) {}
+
+    /**
+     * Evaluate every function in turn at (t, y) and store the results in `dydt`.
+     */
+    void operator()(double t, const double *y, double *dydt) {
+        for (auto j = 0; j < f.size(); j++) {
+            state[j] = y[j];
+        }
+        for (auto j = 0; j < f.size(); j++) {
+            dydt[j] = f[j](t, state);
+        }
+    }
+
+    /**
+     * @return the number of functions in the system.
+     */
+    std::size_t size() const {
+        return f.size();
+    }
+
+private:
+    const std::vector<funcn> &f;
+    std::vector<double> state;
+};
+
+#endif // CHAPTER_6_ODE_SYSTEM_H
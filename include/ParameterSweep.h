@@ -0,0 +1,48 @@
+#pragma once
+#ifndef CHAPTER_6_PARAMETER_SWEEP_H
+#define CHAPTER_6_PARAMETER_SWEEP_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.h"
+
+
+/**
+ * Builds the Cartesian product of several parameter axes. For axes {{1, 2}, {10, 20, 30}} the result is
+ * {{1, 10}, {1, 20}, {1, 30}, {2, 10}, {2, 20}, {2, 30}}: the last axis varies fastest.
+ * @param axes the values of each parameter.
+ * @return one parameter vector per grid point.
+ */
+std::vector<std::vector<double>> parameterGrid(const std::vector<std::vector<double>> &axes);
+
+
+/**
+ * Runs one independent integration per input on a thread pool and collects the results.
+ *
+ * `run` is called as `run(index, inputs[index])`, where the input is typically a parameter vector from
+ * `parameterGrid` or an initial condition vector. The result of each run is stored at the same index as its input, and
+ * runs share no state, so the results are identical whatever the number of threads or the order the runs happen to
+ * finish in. Writing per-run output (e.g. one file per index) from inside `run` is safe for the same reason.
+ *
+ * @param pool the thread pool to run on.
+ * @param inputs the input of each run.
+ * @param run the function performing a single run.
+ * @return the result of each run, in the order of `inputs`.
+ */
+template <typename Input, typename Run>
+auto parameterSweep(ThreadPool &pool, const std::vector<Input> &inputs, Run &&run) {
+    using Result = std::invoke_result_t<Run &, std::size_t, const Input &>;
+
+    // Elements of std::vector<bool> share bytes, so concurrent runs could not write their results independently.
+    static_assert(!std::is_same_v<Result, bool>, "parameterSweep cannot collect bool results");
+
+    std::vector<Result> results(inputs.size());
+    pool.parallelFor(inputs.size(), [&](std::size_t index) {
+        results[index] = run(index, inputs[index]);
+    });
+    return results;
+}
+
+#endif // CHAPTER_6_PARAMETER_SWEEP_H
@@ -0,0 +1,216 @@
+#pragma once
+#ifndef CHAPTER_6_PARAREAL_H
+#define CHAPTER_6_PARAREAL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "RungeKuttaMethod.h"
+#include "ThreadPool.h"
+#include "Trajectory.h"
+#include "TrapezoidalMethod.h"
+
+enum PararealStatus {
+    PARAREAL_STATUS_OK = 0,
+    PARAREAL_STATUS_ERROR_NOT_CONVERGED = 1
+};
+
+
+/**
+ * Settings of the Parareal method.
+ */
+struct PararealOptions {
+    // The number of time slices the interval is split into, each propagated by its own task. Zero uses one per thread
+    // of the pool.
+    int slices = 0;
+
+    // The number of steps the coarse propagator takes across each slice.
+    int coarseSteps = 10;
+
+    // The maximum number of iterations. Zero allows as many as there are slices, after which the result is the serial
+    // fine solution up to rounding, whatever the tolerances.
+    int maxIterations = 0;
+
+    // The iteration has converged when no slice boundary moved by more than
+    // absoluteTolerance + relativeTolerance * |y| in any component.
+    double relativeTolerance = 1e-8;
+    double absoluteTolerance = 1e-10;
+};
+
+
+/**
+ * How the Parareal iteration went.
+ */
+struct PararealReport {
+    // The number of iterations, each of which propagated the slices not yet exact with the fine propagator.
+    int iterations = 0;
+
+    // The largest change of a slice boundary in each iteration, relative to the tolerance (so at most 1 once
+    // converged).
+    std::vector<double> changes;
+};
+
+
+/**
+ * Integrates from y0 across a number of time slices with the Parareal method, which runs an accurate but expensive
+ * fine propagator F on all slices in parallel and corrects the states at the slice boundaries with a cheap coarse
+ * propagator G run serially:
+ *
+ *      U[j + 1] <- G(U'[j]) + F(U[j]) - G(U[j])
+ *
+ * where U are the boundary states of the previous iteration and U' those of the current one. The first iteration
+ * starts from the serial coarse solution. After iteration k the first k + 1 boundaries are exact, so their slices are
+ * not propagated again; the iteration stops once no boundary moves by more than the tolerances.
+ *
+ * With K iterations and as many threads as slices, the wall-clock time is about K times that of one slice of the fine
+ * propagator plus the serial coarse propagation, so it pays off when K is well below the number of slices, i.e. when
+ * G is accurate enough over a slice.
+ *
+ * @param pool the thread pool to run the fine propagator on.
+ * @param coarse the coarse propagator, called as `coarse(j, y, yEnd)` to propagate the state `y` at the start of slice
+ *        `j` to its end. It is only called from the calling thread.
+ * @param fine the fine propagator, called as `fine(j, y, trajectory)` to propagate the state `y` at the start of slice
+ *        `j` to its end, storing the states along the way in `trajectory`. The last row must be the state at the end of
+ *        the slice. It is called for several slices at once from the threads of the pool.
+ * @param y0 the initial condition vector.
+ * @param slices the number of time slices.
+ * @param options the settings. Only the iteration count and tolerances are used.
+ * @param pieces resized to one trajectory per slice, holding the fine solution of the last iteration that propagated
+ *        it. Each starts within the tolerances of the final boundary state.
+ * @param report if not null, filled in with the number of iterations and the change in each.
+ * @return STATUS_OK if the iteration converged, STATUS_ERROR_NOT_CONVERGED if it reached the maximum number of
+ *         iterations first. The pieces then hold the solution of the last iteration.
+ */
+template <typename Coarse, typename Fine>
+PararealStatus parareal(ThreadPool &pool, Coarse &&coarse, Fine &&fine, const std::vector<double> &y0, int slices,
+                        const PararealOptions &options, std::vector<Trajectory> &pieces,
+                        PararealReport *report = nullptr) {
+    auto m = y0.size();
+    auto maxIterations = options.maxIterations > 0 ? std::min(options.maxIterations, slices) : slices;
+
+    // The states at the slice boundaries, and the coarse propagation of each slice from the current ones.
+    std::vector<double> boundaries((slices + 1) * m);
+    std::vector<double> coarseEnds(slices * m);
+    std::vector<double> propagated(m);
+    auto boundary = [&](int j) { return boundaries.data() + j * m; };
+    auto coarseEnd = [&](int j) { return coarseEnds.data() + j * m; };
+
+    // Initial guess from the serial coarse solution.
+    std::copy(y0.begin(), y0.end(), boundary(0));
+    for (auto j = 0; j < slices; j++) {
+        coarse(j, boundary(j), coarseEnd(j));
+        std::copy(coarseEnd(j), coarseEnd(j) + m, boundary(j + 1));
+    }
+
+    pieces.resize(slices);
+    if (report) *report = PararealReport();
+
+    auto status = PARAREAL_STATUS_ERROR_NOT_CONVERGED;
+    for (auto k = 0; k < maxIterations; k++) {
+        // Boundaries 0, ..., k are exact, and so are the fine solutions of the slices before k.
+        pool.parallelFor(slices - k, [&](std::size_t index) {
+            auto j = k + (int) index;
+            fine(j, boundary(j), pieces[j]);
+        });
+
+        // Serial correction. The start of slice k did not change, so neither does its coarse propagation.
+        auto change = 0.0;
+        for (auto j = k; j < slices; j++) {
+            auto fineEnd = pieces[j].row(pieces[j].size() - 1);
+            if (j > k) coarse(j, boundary(j), propagated.data());
+            else std::copy(coarseEnd(j), coarseEnd(j) + m, propagated.begin());
+
+            auto next = boundary(j + 1);
+            for (auto i = 0; i < m; i++) {
+                auto value = propagated[i] + fineEnd[i] - coarseEnd(j)[i];
+                auto scale = options.absoluteTolerance + options.relativeTolerance * std::fabs(value);
+                change = std::max(change, std::fabs(value - next[i]) / scale);
+                next[i] = value;
+            }
+            std::copy(propagated.begin(), propagated.end(), coarseEnd(j));
+        }
+
+        if (report) {
+            report->iterations = k + 1;
+            report->changes.push_back(change);
+        }
+        if (change <= 1) {
+            status = PARAREAL_STATUS_OK;
+            break;
+        }
+    }
+
+    // After as many iterations as slices every boundary is exact.
+    if (maxIterations == slices) status = PARAREAL_STATUS_OK;
+    return status;
+}
+
+
+/**
+ * Uses the Parareal method (see `parareal`) to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with the Runge-Kutta method of order 4 as the fine propagator and
+ * the trapezoidal method with `options.coarseSteps` steps per slice as the coarse one. The time points are those of
+ * `rungeKuttaMethod` with the same number of points, split into slices of (nearly) equal numbers of steps, so the
+ * converged result matches its solution to within the tolerances.
+ *
+ * @param pool the thread pool to run on.
+ * @param f the system, called as `f(t, y, dydt)` from several threads at once. The dimension of the system is
+ *        `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to the dimension of the system.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param options the settings.
+ * @param report if not null, filled in with the number of iterations and the change in each.
+ * @return STATUS_OK if the iteration converged, STATUS_ERROR_NOT_CONVERGED if it reached the maximum number of
+ *         iterations first. The trajectory then holds the solution of the last iteration.
+ */
+template <OdeSystem System>
+PararealStatus pararealMethod(ThreadPool &pool, System &&f, Trajectory &trajectory, const std::vector<double> &y0,
+                              double t0, double t1, const PararealOptions &options = {},
+                              PararealReport *report = nullptr) {
+    auto m = y0.size();
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+    auto slices = std::clamp(options.slices > 0 ? options.slices : (int) pool.size(), 1, std::max(n - 1, 1));
+
+    // Slice j covers steps first(j), ..., first(j + 1) - 1 of the serial method.
+    auto first = [&](int j) { return (long) (n - 1) * j / slices; };
+    auto start = [&](int j) { return t0 + first(j) * h; };
+
+    auto coarse = [&](int j, const double *y, double *yEnd) {
+        auto copy = [&](double t, const double *state) { std::copy(state, state + m, yEnd); };
+        trapezoidalMethod(f, std::vector<double>(y, y + m), start(j), start(j + 1), options.coarseSteps + 1, copy,
+                          OBSERVE_FINAL_STATE_ONLY);
+    };
+    auto fine = [&](int j, const double *y, Trajectory &piece) {
+        piece.resize(first(j + 1) - first(j) + 1, m);
+        rungeKuttaMethod(f, piece, std::vector<double>(y, y + m), start(j), start(j + 1));
+    };
+
+    std::vector<Trajectory> pieces;
+    auto status = parareal(pool, coarse, fine, y0, slices, options, pieces, report);
+
+    // Join the pieces, dropping the first state of each but the first, which repeats the last of the previous one.
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+    auto i = 0;
+    for (auto j = 0; j < slices; j++) {
+        for (auto row = j > 0 ? 1 : 0; row < pieces[j].size(); row++, i++) {
+            trajectory.time(i) = pieces[j].time(row);
+            std::copy(pieces[j].row(row).begin(), pieces[j].row(row).end(), trajectory.row(i).begin());
+        }
+    }
+
+    return status;
+}
+
+#endif // CHAPTER_6_PARAREAL_H
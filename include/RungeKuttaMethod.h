@@ -2,14 +2,22 @@
 #ifndef CHAPTER_6_RUNGE_KUTTA_METHOD_H
 #define CHAPTER_6_RUNGE_KUTTA_METHOD_H
 
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <vector>
 
-using funcn = std::function<double(double t, const std::vector<double> &y)>;
+#include "ButcherTableau.h"
+#include "Checkpoint.h"
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
 
 enum RungeKuttaStatus {
     RUNGE_KUTTA_STATUS_OK = 0,
-    RUNGE_KUTTA_STATUS_ERROR_DIMENSION_MISMATCH = 1
+    RUNGE_KUTTA_STATUS_ERROR_DIMENSION_MISMATCH = 1,
+    RUNGE_KUTTA_STATUS_ERROR_CHECKPOINT_FAILED = 2
 };
 
 
@@ -37,4 +45,570 @@ RungeKuttaStatus rungeKuttaMethod(const std::vector<funcn> &f, std::vector<doubl
                                   std::vector<std::vector<double>> &y, const std::vector<double> &y0, double t0,
                                   double t1);
 
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y1' = f1(t, y1, ..., yn), t0 < t < t1
+ *          :
+ *      yn' = fn(t, y1, ..., yn), t0 < t < t1
+ *
+ * From the initial conditions:
+ *
+ *      y1(t0), ..., yn(t0)
+ *
+ * @param f the vector of functions {f1, ..., fn}.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the number of functions and initial
+ *         conditions does not match.
+ */
+RungeKuttaStatus rungeKuttaMethod(const std::vector<funcn> &f, Trajectory &trajectory, const std::vector<double> &y0,
+                                  double t0, double t1);
+
+
+/**
+ * The number of slope vectors a `StepperWorkspace` needs for `rungeKuttaStep`.
+ */
+constexpr std::size_t RUNGE_KUTTA_STAGES = RUNGE_KUTTA_4_TABLEAU.stages;
+
+
+/**
+ * Takes a single step of the Runge-Kutta method of order 4 for the system y' = f(t, y), using
+ * `explicitRungeKuttaStep` with `RUNGE_KUTTA_4_TABLEAU`.
+ * @param f the system, called as `f(t, y, dydt)`.
+ * @param m the dimension of the system.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param yNext the array to store the state at `t + h` in. It must not alias `y`.
+ * @param workspace scratch storage, already sized for `m` and `RUNGE_KUTTA_STAGES`.
+ */
+template <OdeSystem System>
+void rungeKuttaStep(System &f, std::size_t m, double t, const double *y, double h, double *yNext,
+                    StepperWorkspace &workspace) {
+    explicitRungeKuttaStep<RUNGE_KUTTA_4_TABLEAU>(f, m, t, y, h, yNext, workspace);
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0. The whole derivative vector is computed by a single call to `f`, so
+ * work shared between components is only done once per stage.
+ *
+ * All scratch vectors come from `workspace` and every row of `y` is sized before the time loop, so no allocation
+ * happens while stepping. Passing the same workspace (and result vectors) to later calls avoids allocation entirely.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param t the vector to store the time index in.
+ * @param y the vector to store the result in.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+RungeKuttaStatus rungeKuttaMethod(System &&f, std::vector<double> &t, std::vector<std::vector<double>> &y,
+                                  const std::vector<double> &y0, double t0, double t1,
+                                  StepperWorkspace &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) y.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(m, RUNGE_KUTTA_STAGES);
+    for (auto &entry : y) {
+        entry.resize(m);
+    }
+
+    // Initial conditions.
+    t[0] = t0;
+    y[0] = y0;
+
+    for (auto i = 0; i < n - 1; i++) {
+        rungeKuttaStep(f, m, t[i], y[i].data(), h, y[i + 1].data(), workspace);
+        t[i + 1] = t[i] + h;
+    }
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param t the vector to store the time index in.
+ * @param y the vector to store the result in.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+RungeKuttaStatus rungeKuttaMethod(System &&f, std::vector<double> &t, std::vector<std::vector<double>> &y,
+                                  const std::vector<double> &y0, double t0, double t1) {
+    StepperWorkspace workspace;
+    return rungeKuttaMethod(f, t, y, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, writing every state straight into the contiguous storage of
+ * `trajectory`.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to the dimension of the system.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+RungeKuttaStatus rungeKuttaMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                  double t1, StepperWorkspace &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(m, RUNGE_KUTTA_STAGES);
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+
+    // Initial conditions.
+    trajectory.time(0) = t0;
+    std::copy(y0.begin(), y0.end(), trajectory.row(0).begin());
+
+    for (auto i = 0; i < n - 1; i++) {
+        rungeKuttaStep(f, m, trajectory.time(i), trajectory.row(i).data(), h, trajectory.row(i + 1).data(),
+                       workspace);
+        trajectory.time(i + 1) = trajectory.time(i) + h;
+    }
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+RungeKuttaStatus rungeKuttaMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                  double t1) {
+    StepperWorkspace workspace;
+    return rungeKuttaMethod(f, trajectory, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer` instead of storing them. Only the
+ * current and the next state are kept, so long runs need memory proportional to the dimension of the system only.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus rungeKuttaMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every, StepperWorkspace &workspace) {
+    auto m = y0.size();
+
+    // Two extra stages hold the current and the next state.
+    workspace.resize(m, RUNGE_KUTTA_STAGES + 2);
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        rungeKuttaStep(f, m, t, y, h, yNext, workspace);
+        return true;
+    };
+    integrateFixedSteps(step, y0, t0, t1, n, observer, every, workspace.stage(RUNGE_KUTTA_STAGES),
+                        workspace.stage(RUNGE_KUTTA_STAGES + 1));
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer`, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus rungeKuttaMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every = 1) {
+    StepperWorkspace workspace;
+    return rungeKuttaMethod(f, y0, t0, t1, n, observer, every, workspace);
+}
+
+
+/**
+ * Takes a single step of the Runge-Kutta method of order 4 for a system of fixed dimension `N`, using
+ * `explicitRungeKuttaStep` with `RUNGE_KUTTA_4_TABLEAU`.
+ *
+ * The dimension is known at compile time, so the loops can be fully unrolled and the state kept in registers, with
+ * `f` inlined into the step.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @return the state at `t + h`.
+ */
+template <std::size_t N, OdeSystem System>
+std::array<double, N> rungeKuttaStep(System &f, double t, const std::array<double, N> &y, double h) {
+    return explicitRungeKuttaStep<RUNGE_KUTTA_4_TABLEAU>(f, t, y, h);
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of fixed dimension `N` of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0. This is the same method as the runtime-dimension overloads, but the
+ * state is a `std::array`, so each step is specialized for the dimension. Systems whose dimension is only known at
+ * run time (such as `ExpressionSystem`) use the `std::vector` overloads.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to `N`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <std::size_t N, OdeSystem System>
+RungeKuttaStatus rungeKuttaMethod(System &&f, Trajectory &trajectory, const std::array<double, N> &y0, double t0,
+                                  double t1) {
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, N);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    trajectory.time(0) = t;
+    std::copy(y.begin(), y.end(), trajectory.row(0).begin());
+
+    for (auto i = 0; i < n - 1; i++) {
+        y = rungeKuttaStep(f, t, y, h);
+        t += h;
+        trajectory.time(i + 1) = t;
+        std::copy(y.begin(), y.end(), trajectory.row(i + 1).begin());
+    }
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of fixed dimension `N` of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer` instead of storing them.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <std::size_t N, OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus rungeKuttaMethod(System &&f, const std::array<double, N> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every = 1) {
+    auto h = (t1 - t0) / (n - 1);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    if (shouldObserve(0, n == 1, every) && !observe(observer, t, y.data())) return RUNGE_KUTTA_STATUS_OK;
+
+    for (auto i = 0; i < n - 1; i++) {
+        y = rungeKuttaStep(f, t, y, h);
+        t += h;
+        if (shouldObserve(i + 1, i + 1 == n - 1, every) && !observe(observer, t, y.data())) break;
+    }
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the explicit Runge-Kutta method given by `Tableau` (such as `SSPRK3_TABLEAU` or `THREE_EIGHTHS_RULE_TABLEAU`)
+ * to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with a fixed step size. Every state is written straight into the
+ * contiguous storage of `trajectory`, and no allocation happens while stepping.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to the dimension of the system.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <const auto &Tableau, OdeSystem System>
+RungeKuttaStatus explicitRungeKuttaMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0,
+                                          double t0, double t1, StepperWorkspace &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(m, Tableau.stages);
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+
+    // Initial conditions.
+    trajectory.time(0) = t0;
+    std::copy(y0.begin(), y0.end(), trajectory.row(0).begin());
+
+    for (auto i = 0; i < n - 1; i++) {
+        explicitRungeKuttaStep<Tableau>(f, m, trajectory.time(i), trajectory.row(i).data(), h,
+                                        trajectory.row(i + 1).data(), workspace);
+        trajectory.time(i + 1) = trajectory.time(i) + h;
+    }
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the explicit Runge-Kutta method given by `Tableau` to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with a fixed step size, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <const auto &Tableau, OdeSystem System>
+RungeKuttaStatus explicitRungeKuttaMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0,
+                                          double t0, double t1) {
+    StepperWorkspace workspace;
+    return explicitRungeKuttaMethod<Tableau>(f, trajectory, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the explicit Runge-Kutta method given by `Tableau` to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with a fixed step size, passing the states to `observer` instead of
+ * storing them.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus explicitRungeKuttaMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                          Observer &&observer, int every, StepperWorkspace &workspace) {
+    auto m = y0.size();
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    // Two extra stages hold the current and the next state.
+    workspace.resize(m, stages + 2);
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        explicitRungeKuttaStep<Tableau>(f, m, t, y, h, yNext, workspace);
+        return true;
+    };
+    integrateFixedSteps(step, y0, t0, t1, n, observer, every, workspace.stage(stages), workspace.stage(stages + 1));
+
+    return RUNGE_KUTTA_STATUS_OK;
+}
+
+
+/**
+ * Uses the explicit Runge-Kutta method given by `Tableau` to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, with a fixed step size, passing the states to `observer`, using a
+ * temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus explicitRungeKuttaMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                          Observer &&observer, int every = 1) {
+    StepperWorkspace workspace;
+    return explicitRungeKuttaMethod<Tableau>(f, y0, t0, t1, n, observer, every, workspace);
+}
+
+
+/**
+ * Uses the explicit Runge-Kutta method given by `Tableau` to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with its fixed step size, passing the states to `observer`. The checkpoint is advanced
+ * in place and written to `options.filename` every `options.every` steps and at the end, so an interrupted run can be
+ * resumed from the last file written, and a finished one extended to a later `t1`, with exactly the same results as
+ * an uninterrupted run.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0, h)` to start from the initial conditions.
+ * @param t1 the final time. The number of steps is `(t1 - checkpoint.t) / checkpoint.h`, rounded to the nearest
+ *        integer.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th state (and the final one), counted from the initial conditions, or only the
+ *        final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_CHECKPOINT_FAILED if the checkpoint was recorded by another
+ *         method or has no step size, or if writing it failed.
+ */
+template <const auto &Tableau, OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus explicitRungeKuttaMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer,
+                                          int every, const CheckpointOptions &options, StepperWorkspace &workspace) {
+    auto m = checkpoint.y.size();
+    constexpr auto stages = std::remove_cvref_t<decltype(Tableau)>::stages;
+
+    // Two extra stages hold the current and the next state.
+    workspace.resize(m, stages + 2);
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        explicitRungeKuttaStep<Tableau>(f, m, t, y, h, yNext, workspace);
+        return true;
+    };
+    auto completed = integrateFixedSteps(step, checkpoint, Tableau.order, butcherTableauId(Tableau), t1, observer,
+                                         every, options, workspace.stage(stages), workspace.stage(stages + 1));
+
+    return completed ? RUNGE_KUTTA_STATUS_OK : RUNGE_KUTTA_STATUS_ERROR_CHECKPOINT_FAILED;
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with its fixed step size, passing the states to `observer` (see
+ * `explicitRungeKuttaMethod`).
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0, h)` to start from the initial conditions.
+ * @param t1 the final time. The number of steps is `(t1 - checkpoint.t) / checkpoint.h`, rounded to the nearest
+ *        integer.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th state (and the final one), counted from the initial conditions, or only the
+ *        final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_CHECKPOINT_FAILED if the checkpoint was recorded by another
+ *         method or has no step size, or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus rungeKuttaMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer, int every,
+                                  const CheckpointOptions &options, StepperWorkspace &workspace) {
+    return explicitRungeKuttaMethod<RUNGE_KUTTA_4_TABLEAU>(f, checkpoint, t1, observer, every, options, workspace);
+}
+
+
+/**
+ * Uses the Runge-Kutta method of order 4 to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with its fixed step size, passing the states to `observer`, using a temporary
+ * workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0, h)` to start from the initial conditions.
+ * @param t1 the final time.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th state (and the final one), counted from the initial conditions, or only the
+ *        final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_CHECKPOINT_FAILED if the checkpoint was recorded by another
+ *         method or has no step size, or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+RungeKuttaStatus rungeKuttaMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer, int every = 1,
+                                  const CheckpointOptions &options = {}) {
+    StepperWorkspace workspace;
+    return rungeKuttaMethod(f, checkpoint, t1, observer, every, options, workspace);
+}
+
 #endif // CHAPTER_6_RUNGE_KUTTA_METHOD_H
@@ -0,0 +1,264 @@
+#pragma once
+#ifndef CHAPTER_6_SOLVER_STATS_H
+#define CHAPTER_6_SOLVER_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Observer.h"
+#include "OdeSystem.h"
+
+
+/**
+ * How often one kind of operation ran and how long it took.
+ *
+ * Reading the clock costs about as much as evaluating a small system, so only one call in every
+ * `SolverStats::timingInterval` is timed and the total is extrapolated from those.
+ */
+struct OperationStats {
+    long calls = 0;
+    long timedCalls = 0;
+    double timedSeconds = 0;
+
+    // The number of calls until the next timed one.
+    long untilTimed = 0;
+
+    /**
+     * @return the estimated total time spent in the operation.
+     */
+    double seconds() const {
+        return timedCalls > 0 ? timedSeconds * calls / timedCalls : 0;
+    }
+};
+
+
+/**
+ * Counters and timings filled in by the solvers, cheap enough to leave on in production.
+ *
+ * The solvers fill in a `SolverStats` when the system they are given is wrapped by `instrumentSystem`; nothing is
+ * recorded (or costs anything) otherwise:
+ *
+ *      SolverStats stats;
+ *      rungeKuttaMethod(instrumentSystem(f, stats), y0, t0, t1, n, instrumentObserver(observer, stats));
+ *      writeSolverStats(std::cout, stats);
+ *
+ * The scalar `backwardEulerMethod` takes a pointer to one instead.
+ */
+struct SolverStats {
+    // Time one call in every `timingInterval` of each operation, or none if zero. One times every call.
+    long timingInterval = 64;
+
+    // Evaluations of the system by the solver, including those made to select step sizes.
+    OperationStats rhs;
+
+    // Evaluations of the Jacobian, and the evaluations of the system they make (finite difference Jacobians of an
+    // instrumented system). The time of the latter is part of the Jacobian's, not of `rhs`.
+    OperationStats jacobian;
+    OperationStats jacobianRhs;
+    bool inJacobian = false;
+
+    // LU factorizations and solves of Newton iteration matrices.
+    OperationStats linearAlgebra;
+
+    // Calls to an observer wrapped by `instrumentObserver`.
+    OperationStats output;
+
+    // Attempted steps, including rejected ones, and the steps the error control rejected or, in the backward Euler
+    // method, whose Newton iteration failed so that they were retried with half the step size.
+    long steps = 0;
+    long rejectedSteps = 0;
+
+    // Newton iterations in total, the number of steps that took each number of iterations (index 0 counts steps that
+    // took none), and the steps whose Newton iteration failed.
+    long newtonIterations = 0;
+    std::vector<long> newtonHistogram;
+    long newtonFailures = 0;
+
+    // The wall-clock time of the runs measured by `profileSolver`.
+    double wallSeconds = 0;
+
+    /**
+     * Record the Newton solve of one implicit step.
+     * @param iterations the number of iterations it took.
+     * @param converged whether it converged.
+     */
+    void recordNewtonSolve(int iterations, bool converged) {
+        newtonIterations += iterations;
+        if (newtonHistogram.size() <= iterations) newtonHistogram.resize(iterations + 1);
+        newtonHistogram[iterations]++;
+        if (!converged) newtonFailures++;
+    }
+};
+
+
+/**
+ * Add a timed call that started at `start` and has just finished to `stats`, less the time spent reading the clock.
+ */
+void recordTimedCall(OperationStats &stats, std::chrono::steady_clock::time_point start);
+
+
+/**
+ * Run `operation` as one call of `stats`, timing it if it is one of the sampled calls.
+ *
+ * The untimed path is a decrement and a branch. The bookkeeping of timed calls is kept out of line so it does not
+ * stop the compiler from keeping the solver's state in registers.
+ *
+ * @return the result of `operation`.
+ */
+template <typename Operation>
+auto measureOperation(const SolverStats &solver, OperationStats &stats, Operation &&operation) {
+    // A countdown rather than `calls % timingInterval`, which would cost a division per call.
+    stats.calls++;
+    if (solver.timingInterval <= 0 || --stats.untilTimed > 0) return operation();
+    stats.untilTimed = solver.timingInterval;
+
+    auto start = std::chrono::steady_clock::now();
+    if constexpr (std::is_void_v<decltype(operation())>) {
+        operation();
+        recordTimedCall(stats, start);
+    }
+    else {
+        auto result = operation();
+        recordTimedCall(stats, start);
+        return result;
+    }
+}
+
+
+/**
+ * A system that counts and times its evaluations in a `SolverStats`. The solvers recognize it (see `solverStats`) and
+ * also record their steps, Newton iterations and linear algebra in the same object.
+ */
+template <OdeSystem System>
+class InstrumentedSystem {
+public:
+    /**
+     * @param f the system to evaluate.
+     * @param stats the statistics to fill in. It must outlive this object.
+     */
+    InstrumentedSystem(System f, SolverStats &stats) : f(std::move(f)), stats(&stats) {}
+
+    void operator()(double t, const double *y, double *dydt) {
+        // A single call site, so `f` is inlined once.
+        measureOperation(*stats, stats->inJacobian ? stats->jacobianRhs : stats->rhs, [&] { f(t, y, dydt); });
+    }
+
+    SolverStats *solverStats() const {
+        return stats;
+    }
+
+private:
+    System f;
+    SolverStats *stats;
+};
+
+
+/**
+ * An observer that times its calls in a `SolverStats`, as `output`.
+ */
+template <SolverObserver Observer>
+class InstrumentedObserver {
+public:
+    /**
+     * @param observer the observer to forward the states to.
+     * @param stats the statistics to fill in. It must outlive this object.
+     */
+    InstrumentedObserver(Observer observer, SolverStats &stats) : observer(std::move(observer)), stats(&stats) {}
+
+    bool operator()(double t, const double *y) {
+        return measureOperation(*stats, stats->output, [&] { return observe(observer, t, y); });
+    }
+
+private:
+    Observer observer;
+    SolverStats *stats;
+};
+
+
+/**
+ * Wrap a system so that solving it fills in `stats`.
+ * @param f the system, copied into the wrapper.
+ * @param stats the statistics to fill in. It must outlive the wrapper.
+ */
+template <OdeSystem System>
+InstrumentedSystem<std::decay_t<System>> instrumentSystem(System &&f, SolverStats &stats) {
+    return {std::forward<System>(f), stats};
+}
+
+/**
+ * Wrap an observer so that the time spent in it is recorded in `stats`.
+ * @param observer the observer, copied into the wrapper.
+ * @param stats the statistics to fill in. It must outlive the wrapper.
+ */
+template <SolverObserver Observer>
+InstrumentedObserver<std::decay_t<Observer>> instrumentObserver(Observer &&observer, SolverStats &stats) {
+    return {std::forward<Observer>(observer), stats};
+}
+
+
+/**
+ * @return the statistics a system wrapped by `instrumentSystem` fills in, or null for any other system. The solvers
+ *         call this once per step; for plain systems it is a constant null pointer, so the recording code compiles
+ *         away.
+ */
+template <typename System>
+SolverStats *solverStats(System &f) {
+    if constexpr (requires { f.solverStats(); }) {
+        return f.solverStats();
+    }
+    else {
+        return nullptr;
+    }
+}
+
+
+/**
+ * Evaluate a Jacobian as one call of `stats.jacobian`. Evaluations of an instrumented system made meanwhile are
+ * counted in `stats.jacobianRhs`.
+ */
+template <OdeJacobian Jacobian>
+void measureJacobian(SolverStats &stats, Jacobian &fy, double t, const double *y, double *jacobian) {
+    stats.inJacobian = true;
+    measureOperation(stats, stats.jacobian, [&] { fy(t, y, jacobian); });
+    stats.inJacobian = false;
+}
+
+
+/**
+ * Run a solver and add its wall-clock time to `stats`, so the time not spent in the system, the Jacobian, linear
+ * algebra or output can be told apart:
+ *
+ *      auto result = profileSolver(stats, [&] { return rungeKuttaMethod(instrumentSystem(f, stats), ...); });
+ *
+ * @return the result of `run`.
+ */
+template <typename Run>
+decltype(auto) profileSolver(SolverStats &stats, Run &&run) {
+    struct Timer {
+        SolverStats &stats;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        ~Timer() {
+            stats.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    Timer timer{stats};
+    return run();
+}
+
+
+/**
+ * Write the statistics as a JSON object: the counters, the Newton histogram and the estimated seconds spent in each
+ * operation, plus the remainder of the wall-clock time if `profileSolver` measured it.
+ * @param stream the stream to write to.
+ * @param stats the statistics to write.
+ * @return the stream.
+ */
+std::ostream &writeSolverStats(std::ostream &stream, const SolverStats &stats);
+
+#endif // CHAPTER_6_SOLVER_STATS_H
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef CHAPTER_6_STEPPER_WORKSPACE_H
+#define CHAPTER_6_STEPPER_WORKSPACE_H
+
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * Scratch storage for the explicit steppers: one slope vector per stage plus a temporary state vector.
+ *
+ * All buffers live in a single allocation that is made by `resize` before the time loop starts. Resizing to the same
+ * or a smaller shape never reallocates, so one workspace can be reused across any number of integrations without
+ * touching the heap again.
+ */
+class StepperWorkspace {
+public:
+    StepperWorkspace() = default;
+
+    StepperWorkspace(std::size_t dimension, std::size_t stages) {
+        resize(dimension, stages);
+    }
+
+    /**
+     * Make room for `stages` slope vectors and one temporary vector, each of `dimension` entries.
+     */
+    void resize(std::size_t dimension, std::size_t stages) {
+        m = dimension;
+        s = stages;
+        buffer.resize((stages + 1) * dimension);
+    }
+
+    /**
+     * @return the slope vector of stage `index` (0-based).
+     */
+    double *stage(std::size_t index) {
+        return buffer.data() + index * m;
+    }
+
+    /**
+     * @return the temporary state vector.
+     */
+    double *temp() {
+        return buffer.data() + s * m;
+    }
+
+    /**
+     * @return the dimension the workspace was last sized for.
+     */
+    std::size_t dimension() const {
+        return m;
+    }
+
+private:
+    std::size_t m = 0;
+    std::size_t s = 0;
+    std::vector<double> buffer;
+};
+
+#endif // CHAPTER_6_STEPPER_WORKSPACE_H
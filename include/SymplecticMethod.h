@@ -0,0 +1,337 @@
+#pragma once
+#ifndef CHAPTER_6_SYMPLECTIC_METHOD_H
+#define CHAPTER_6_SYMPLECTIC_METHOD_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "SolverStats.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
+
+enum SymplecticStatus {
+    SYMPLECTIC_STATUS_OK = 0,
+    SYMPLECTIC_STATUS_ERROR_DIMENSION_MISMATCH = 1
+};
+
+
+/**
+ * A symplectic method for separable systems, written as a composition of velocity Verlet steps with sizes
+ * w_1 h, ..., w_S h (the weights sum to 1). Velocity Verlet itself is the single step with weight 1; the Yoshida
+ * methods raise the order by composing steps with symmetric weights, some of them negative.
+ *
+ * Like the Butcher tableaus, schemes are `constexpr` data advanced by a single `symplecticStep`.
+ */
+template <std::size_t S>
+struct SymplecticScheme {
+    static constexpr std::size_t steps = S;
+
+    double weights[S] = {};
+    int order = 0;
+};
+
+
+/**
+ * Velocity Verlet (the leapfrog method in kick-drift-kick form), order 2. The acceleration at the end of a step is the
+ * one at the start of the next, so each step needs a single evaluation.
+ */
+inline constexpr SymplecticScheme<1> VELOCITY_VERLET_SCHEME = {
+    .weights = {1},
+    .order = 2
+};
+
+/**
+ * Yoshida's composition of three velocity Verlet steps, order 4. Three evaluations per step.
+ */
+inline constexpr SymplecticScheme<3> YOSHIDA_4_SCHEME = {
+    .weights = {1.3512071919596576, -1.7024143839193153, 1.3512071919596576},
+    .order = 4
+};
+
+/**
+ * Yoshida's composition of seven velocity Verlet steps (his solution A), order 6. Seven evaluations per step.
+ */
+inline constexpr SymplecticScheme<7> YOSHIDA_6_SCHEME = {
+    .weights = {0.78451361047755726, 0.23557321335935813, -1.1776799841788710, 1.3151863206839112,
+                -1.1776799841788710, 0.23557321335935813, 0.78451361047755726},
+    .order = 6
+};
+
+
+/**
+ * Takes a single step of the symplectic method given by `Scheme` for a separable second order system
+ *
+ *      q' = v, v' = a(t, q)
+ *
+ * The state is updated in place. Each velocity Verlet substep kicks the velocity by half a step, drifts the position
+ * a full step and kicks the velocity again with the acceleration at the new position, which is then kept for the next
+ * substep.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)`.
+ * @param d the number of positions (half the dimension of the system).
+ * @param t the time at the start of the step.
+ * @param q the positions, updated to `t + h`.
+ * @param v the velocities, updated to `t + h`.
+ * @param h the step size.
+ * @param acceleration on entry a(t, q), on exit a(t + h, q) at the new positions.
+ */
+template <const auto &Scheme, OdeSystem Acceleration>
+inline void symplecticStep(Acceleration &a, std::size_t d, double t, double *q, double *v, double h,
+                           double *acceleration) {
+    constexpr auto steps = std::remove_cvref_t<decltype(Scheme)>::steps;
+    if (auto stats = solverStats(a)) stats->steps++;
+
+    for (std::size_t s = 0; s < steps; s++) {
+        const auto w = Scheme.weights[s] * h;
+        for (auto j = 0; j < d; j++) {
+            v[j] += 0.5 * w * acceleration[j];
+            q[j] += w * v[j];
+        }
+        t += w;
+        a(t, q, acceleration);
+        for (auto j = 0; j < d; j++) {
+            v[j] += 0.5 * w * acceleration[j];
+        }
+    }
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` (such as `VELOCITY_VERLET_SCHEME` or `YOSHIDA_4_SCHEME`) to solve a
+ * separable second order system of the form:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd), with a fixed step size. Symplectic
+ * methods do not let the energy of conservative systems (orbits, undamped pendulums) drift: its error stays bounded
+ * over arbitrarily long runs instead of growing with time.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `d` positions.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to the dimension of the system.
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if `y0` has an odd number of entries.
+ */
+template <const auto &Scheme, OdeSystem Acceleration>
+SymplecticStatus symplecticMethod(Acceleration &&a, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                  double t1, StepperWorkspace &workspace) {
+    if (y0.size() % 2 != 0) return SYMPLECTIC_STATUS_ERROR_DIMENSION_MISMATCH;
+
+    // m is the number of systems, d the number of positions and n is the number of time steps.
+    auto m = y0.size();
+    auto d = m / 2;
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(d, 1);
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+
+    // Initial conditions.
+    trajectory.time(0) = t0;
+    std::copy(y0.begin(), y0.end(), trajectory.row(0).begin());
+
+    auto acceleration = workspace.stage(0);
+    a(t0, y0.data(), acceleration);
+
+    for (auto i = 0; i < n - 1; i++) {
+        auto y = trajectory.row(i + 1).data();
+        std::copy(trajectory.row(i).begin(), trajectory.row(i).end(), y);
+        symplecticStep<Scheme>(a, d, trajectory.time(i), y, y + d, h, acceleration);
+        trajectory.time(i + 1) = trajectory.time(i) + h;
+    }
+
+    return SYMPLECTIC_STATUS_OK;
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` to solve a separable second order system of the form:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd), with a fixed step size, using a temporary
+ * workspace.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `d` positions.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if `y0` has an odd number of entries.
+ */
+template <const auto &Scheme, OdeSystem Acceleration>
+SymplecticStatus symplecticMethod(Acceleration &&a, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                  double t1) {
+    StepperWorkspace workspace;
+    return symplecticMethod<Scheme>(a, trajectory, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` to solve a separable second order system of the form:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd), with a fixed step size, passing the
+ * states to `observer` instead of storing them.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `d` positions.
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if `y0` has an odd number of entries.
+ */
+template <const auto &Scheme, OdeSystem Acceleration, SolverObserver Observer>
+SymplecticStatus symplecticMethod(Acceleration &&a, const std::vector<double> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every, StepperWorkspace &workspace) {
+    if (y0.size() % 2 != 0) return SYMPLECTIC_STATUS_ERROR_DIMENSION_MISMATCH;
+
+    auto m = y0.size();
+    auto d = m / 2;
+
+    // Stages 0 and 1 hold the current and the next state, the first half of stage 2 the acceleration.
+    workspace.resize(m, 3);
+    auto acceleration = workspace.stage(2);
+    a(t0, y0.data(), acceleration);
+
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        std::copy(y, y + m, yNext);
+        symplecticStep<Scheme>(a, d, t, yNext, yNext + d, h, acceleration);
+        return true;
+    };
+    integrateFixedSteps(step, y0, t0, t1, n, observer, every, workspace.stage(0), workspace.stage(1));
+
+    return SYMPLECTIC_STATUS_OK;
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` to solve a separable second order system of the form:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd), passing the states to `observer`, using a
+ * temporary workspace.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `d` positions.
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if `y0` has an odd number of entries.
+ */
+template <const auto &Scheme, OdeSystem Acceleration, SolverObserver Observer>
+SymplecticStatus symplecticMethod(Acceleration &&a, const std::vector<double> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every = 1) {
+    StepperWorkspace workspace;
+    return symplecticMethod<Scheme>(a, y0, t0, t1, n, observer, every, workspace);
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` to solve a separable second order system of fixed dimension `N`:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd). The number of positions `N / 2` is known
+ * at compile time, so the loops of each step are unrolled and the state kept in registers.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `N / 2` positions.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to `N`.
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <const auto &Scheme, std::size_t N, OdeSystem Acceleration>
+requires (N % 2 == 0)
+SymplecticStatus symplecticMethod(Acceleration &&a, Trajectory &trajectory, const std::array<double, N> &y0,
+                                  double t0, double t1) {
+    constexpr auto d = N / 2;
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, N);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    trajectory.time(0) = t;
+    std::copy(y.begin(), y.end(), trajectory.row(0).begin());
+
+    std::array<double, d> acceleration;
+    a(t, y.data(), acceleration.data());
+
+    for (auto i = 0; i < n - 1; i++) {
+        symplecticStep<Scheme>(a, d, t, y.data(), y.data() + d, h, acceleration.data());
+        t += h;
+        trajectory.time(i + 1) = t;
+        std::copy(y.begin(), y.end(), trajectory.row(i + 1).begin());
+    }
+
+    return SYMPLECTIC_STATUS_OK;
+}
+
+
+/**
+ * Uses the symplectic method given by `Scheme` to solve a separable second order system of fixed dimension `N`:
+ *
+ *      q' = v, v' = a(t, q), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0 = (q1, ..., qd, v1, ..., vd), passing the states to `observer` instead
+ * of storing them.
+ *
+ * @param a the acceleration, called as `a(t, q, acceleration)` with `N / 2` positions.
+ * @param y0 the initial condition vector, positions first and velocities second.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <const auto &Scheme, std::size_t N, OdeSystem Acceleration, SolverObserver Observer>
+requires (N % 2 == 0)
+SymplecticStatus symplecticMethod(Acceleration &&a, const std::array<double, N> &y0, double t0, double t1, int n,
+                                  Observer &&observer, int every = 1) {
+    constexpr auto d = N / 2;
+    auto h = (t1 - t0) / (n - 1);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    if (shouldObserve(0, n == 1, every) && !observe(observer, t, y.data())) return SYMPLECTIC_STATUS_OK;
+
+    std::array<double, d> acceleration;
+    a(t, y.data(), acceleration.data());
+
+    for (auto i = 0; i < n - 1; i++) {
+        symplecticStep<Scheme>(a, d, t, y.data(), y.data() + d, h, acceleration.data());
+        t += h;
+        if (shouldObserve(i + 1, i + 1 == n - 1, every) && !observe(observer, t, y.data())) break;
+    }
+
+    return SYMPLECTIC_STATUS_OK;
+}
+
+#endif // CHAPTER_6_SYMPLECTIC_METHOD_H
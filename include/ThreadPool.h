@@ -0,0 +1,72 @@
+#pragma once
+#ifndef CHAPTER_6_THREAD_POOL_H
+#define CHAPTER_6_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * A fixed set of worker threads that run independent tasks with work stealing.
+ *
+ * `parallelFor` splits the indices 0, ..., count - 1 into one contiguous block per worker. Each worker takes tasks
+ * from the front of its own block and, when that runs out, steals from the back of another worker's block, so uneven
+ * task costs still keep every core busy. Which thread runs a task is not deterministic, so tasks should only write
+ * results owned by their own index.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads the number of worker threads. Zero uses one per hardware thread.
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @return the number of worker threads.
+     */
+    std::size_t size() const;
+
+    /**
+     * Run `task(i)` for every i in 0, ..., count - 1 and wait for all of them to finish. If any task throws, the first
+     * exception is rethrown here once the others have finished.
+     * @param count the number of tasks.
+     * @param task the task to run for each index.
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t index)> &task);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::size_t> queue;
+    };
+
+    void run(std::size_t self);
+    bool take(std::size_t self, std::size_t &index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Everything below is guarded by `mutex`.
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(std::size_t)> *task = nullptr;
+    std::size_t generation = 0;
+    std::size_t remaining = 0;
+    std::size_t active = 0;
+    std::exception_ptr error;
+    bool stopping = false;
+};
+
+#endif // CHAPTER_6_THREAD_POOL_H
@@ -0,0 +1,197 @@
+#pragma once
+#ifndef CHAPTER_6_TRAJECTORY_H
+#define CHAPTER_6_TRAJECTORY_H
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+enum TrajectoryLayout {
+    TRAJECTORY_LAYOUT_ROW_MAJOR = 0,
+    TRAJECTORY_LAYOUT_COLUMN_MAJOR = 1
+};
+
+
+/**
+ * The result of an integration: `size()` time points and, for each one, a state of `dimension()` entries.
+ *
+ * All states are held in one contiguous buffer. In row-major layout (the default, and the one the solvers write) the
+ * state at each time point is contiguous and available through `row`. In column-major layout each component's whole
+ * history is contiguous and available through `column`, which suits per-component post-processing. `setLayout`
+ * converts between the two, and `operator()` works in either.
+ */
+class Trajectory {
+public:
+    Trajectory() = default;
+
+    /**
+     * @param steps the number of time points.
+     * @param dimension the number of components in each state.
+     * @param layout the storage layout.
+     */
+    Trajectory(std::size_t steps, std::size_t dimension, TrajectoryLayout layout = TRAJECTORY_LAYOUT_ROW_MAJOR)
+            : m(dimension), order(layout), times(steps), values(steps * dimension) {}
+
+    /**
+     * Change the number of time points and components. Existing values are not preserved unless only the number of
+     * time points changes in row-major layout.
+     */
+    void resize(std::size_t steps, std::size_t dimension) {
+        m = dimension;
+        times.resize(steps);
+        values.resize(steps * dimension);
+    }
+
+    /**
+     * Reserve room for `steps` time points so that `append` does not reallocate.
+     */
+    void reserve(std::size_t steps) {
+        times.reserve(steps);
+        values.reserve(steps * m);
+    }
+
+    /**
+     * Remove every time point, keeping the dimension and the allocated storage.
+     */
+    void clear() {
+        times.clear();
+        values.clear();
+    }
+
+    /**
+     * Add a time point to the end of a row-major trajectory.
+     * @param t the time.
+     * @param y the state (must have `dimension()` entries).
+     */
+    void append(double t, const double *y) {
+        assert(order == TRAJECTORY_LAYOUT_ROW_MAJOR);
+        times.push_back(t);
+        values.insert(values.end(), y, y + m);
+    }
+
+    /**
+     * @return the number of time points.
+     */
+    std::size_t size() const {
+        return times.size();
+    }
+
+    /**
+     * @return the number of components in each state.
+     */
+    std::size_t dimension() const {
+        return m;
+    }
+
+    /**
+     * @return the storage layout.
+     */
+    TrajectoryLayout layout() const {
+        return order;
+    }
+
+    /**
+     * Rearrange the states into the given layout. This is a no-op if the layout already matches.
+     */
+    void setLayout(TrajectoryLayout layout) {
+        if (layout == order) return;
+
+        auto n = size();
+        std::vector<double> rearranged(values.size());
+        for (auto i = 0; i < n; i++) {
+            for (auto j = 0; j < m; j++) {
+                if (layout == TRAJECTORY_LAYOUT_COLUMN_MAJOR) {
+                    rearranged[j * n + i] = values[i * m + j];
+                }
+                else {
+                    rearranged[i * m + j] = values[j * n + i];
+                }
+            }
+        }
+        values.swap(rearranged);
+        order = layout;
+    }
+
+    /**
+     * @return the time of time point `i`.
+     */
+    double &time(std::size_t i) {
+        return times[i];
+    }
+
+    double time(std::size_t i) const {
+        return times[i];
+    }
+
+    /**
+     * @return every time point.
+     */
+    std::span<double> time() {
+        return times;
+    }
+
+    std::span<const double> time() const {
+        return times;
+    }
+
+    /**
+     * @return component `j` of the state at time point `i`.
+     */
+    double &operator()(std::size_t i, std::size_t j) {
+        return values[index(i, j)];
+    }
+
+    double operator()(std::size_t i, std::size_t j) const {
+        return values[index(i, j)];
+    }
+
+    /**
+     * @return the state at time point `i`. Only available in row-major layout.
+     */
+    std::span<double> row(std::size_t i) {
+        assert(order == TRAJECTORY_LAYOUT_ROW_MAJOR);
+        return {values.data() + i * m, m};
+    }
+
+    std::span<const double> row(std::size_t i) const {
+        assert(order == TRAJECTORY_LAYOUT_ROW_MAJOR);
+        return {values.data() + i * m, m};
+    }
+
+    /**
+     * @return the history of component `j`. Only available in column-major layout.
+     */
+    std::span<double> column(std::size_t j) {
+        assert(order == TRAJECTORY_LAYOUT_COLUMN_MAJOR);
+        return {values.data() + j * size(), size()};
+    }
+
+    std::span<const double> column(std::size_t j) const {
+        assert(order == TRAJECTORY_LAYOUT_COLUMN_MAJOR);
+        return {values.data() + j * size(), size()};
+    }
+
+    /**
+     * @return every state value, in storage order.
+     */
+    std::span<double> data() {
+        return values;
+    }
+
+    std::span<const double> data() const {
+        return values;
+    }
+
+private:
+    std::size_t index(std::size_t i, std::size_t j) const {
+        return order == TRAJECTORY_LAYOUT_ROW_MAJOR ? i * m + j : j * size() + i;
+    }
+
+    std::size_t m = 0;
+    TrajectoryLayout order = TRAJECTORY_LAYOUT_ROW_MAJOR;
+    std::vector<double> times;
+    std::vector<double> values;
+};
+
+#endif // CHAPTER_6_TRAJECTORY_H
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef CHAPTER_6_TRAJECTORY_FILE_H
+#define CHAPTER_6_TRAJECTORY_FILE_H
+
+#include <bit>
+#include <cstdint>
+#include <string>
+
+#include "Trajectory.h"
+
+enum TrajectoryFileStatus {
+    TRAJECTORY_FILE_STATUS_OK = 0,
+    TRAJECTORY_FILE_STATUS_ERROR_OPEN_FAILED = 1,
+    TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED = 2,
+    TRAJECTORY_FILE_STATUS_ERROR_INVALID_FORMAT = 3
+};
+
+enum TrajectoryFileFormat {
+    // Chosen from the file name: binary for names ending in `.bin`, CSV otherwise.
+    TRAJECTORY_FILE_FORMAT_AUTOMATIC = 0,
+    TRAJECTORY_FILE_FORMAT_CSV = 1,
+    TRAJECTORY_FILE_FORMAT_BINARY = 2
+};
+
+enum TrajectoryFileType : std::uint32_t {
+    TRAJECTORY_FILE_TYPE_FLOAT64 = 1,
+    TRAJECTORY_FILE_TYPE_FLOAT32 = 2
+};
+
+enum TrajectoryFileTimeLayout : std::uint32_t {
+    // Every row is `t, y1, ..., yn`, exactly like the columns of the CSV format.
+    TRAJECTORY_FILE_TIME_LAYOUT_COLUMN = 0,
+    // Rows are `y1, ..., yn` only. Time point i is t0 + i * h, with t0 and h taken from the header.
+    TRAJECTORY_FILE_TIME_LAYOUT_UNIFORM = 1
+};
+
+
+/**
+ * The 64 byte header at the start of a binary trajectory file. All fields and values are little-endian: the file is
+ * written as laid out in memory, so only little-endian targets are supported. The rows follow immediately, `count` of
+ * them, each of `dimension` (plus one for the time column) values of type `type`, so the data can be memory-mapped as
+ * a `count x columns` array without any parsing.
+ */
+struct TrajectoryFileHeader {
+    char magic[8] = {'C', '6', 'T', 'R', 'A', 'J', '\0', '\0'};
+    std::uint32_t version = 1;
+    std::uint32_t type = TRAJECTORY_FILE_TYPE_FLOAT64;
+    std::uint32_t timeLayout = TRAJECTORY_FILE_TIME_LAYOUT_COLUMN;
+    std::uint32_t reserved = 0;
+    std::uint64_t dimension = 0;
+    std::uint64_t count = 0;
+    double t0 = 0;
+    double h = 0;
+    char padding[8] = {};
+};
+
+static_assert(sizeof(TrajectoryFileHeader) == 64, "the trajectory file header must be exactly 64 bytes");
+static_assert(std::endian::native == std::endian::little, "trajectory files are little-endian");
+
+
+/**
+ * Write a trajectory to a file, either as CSV (one `t, y1, ..., yn` line per time point) or in the binary format
+ * described by `TrajectoryFileHeader`.
+ * @param filename the file to write.
+ * @param trajectory the trajectory to write.
+ * @param format the file format.
+ * @param type the value type of binary files.
+ * @param timeLayout how binary files store the time points. The uniform layout should only be used for fixed-step
+ *        results.
+ * @return STATUS_OK if the file was written, STATUS_ERROR_OPEN_FAILED if it could not be opened or
+ *         STATUS_ERROR_IO_FAILED if writing failed.
+ */
+TrajectoryFileStatus writeTrajectory(const std::string &filename, const Trajectory &trajectory,
+                                     TrajectoryFileFormat format = TRAJECTORY_FILE_FORMAT_AUTOMATIC,
+                                     TrajectoryFileType type = TRAJECTORY_FILE_TYPE_FLOAT64,
+                                     TrajectoryFileTimeLayout timeLayout = TRAJECTORY_FILE_TIME_LAYOUT_COLUMN);
+
+/**
+ * Read a trajectory from a binary trajectory file.
+ * @param filename the file to read.
+ * @param trajectory the trajectory to store the result in (in row-major layout).
+ * @return STATUS_OK if the file was read, STATUS_ERROR_OPEN_FAILED if it could not be opened,
+ *         STATUS_ERROR_IO_FAILED if it is shorter than its header says (checked before anything is allocated) or
+ *         STATUS_ERROR_INVALID_FORMAT if it is not a trajectory file.
+ */
+TrajectoryFileStatus readTrajectory(const std::string &filename, Trajectory &trajectory);
+
+#endif // CHAPTER_6_TRAJECTORY_FILE_H
@@ -2,14 +2,22 @@
 #ifndef CHAPTER_6_TRAPEZOIDAL_METHOD_H
 #define CHAPTER_6_TRAPEZOIDAL_METHOD_H
 
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <vector>
 
-using funcn = std::function<double(double t, const std::vector<double> &y)>;
+#include "ButcherTableau.h"
+#include "Checkpoint.h"
+#include "Observer.h"
+#include "OdeSystem.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
 
 enum TrapezoidalStatus {
     TRAPEZOIDAL_STATUS_OK = 0,
-    TRAPEZOIDAL_STATUS_ERROR_DIMENSION_MISMATCH = 1
+    TRAPEZOIDAL_STATUS_ERROR_DIMENSION_MISMATCH = 1,
+    TRAPEZOIDAL_STATUS_ERROR_CHECKPOINT_FAILED = 2
 };
 
 
@@ -37,4 +45,414 @@ TrapezoidalStatus trapezoidalMethod(const std::vector<funcn> &f, std::vector<dou
                                     std::vector<std::vector<double>> &y, const std::vector<double> &y0, double t0,
                                     double t1);
 
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y1' = f1(t, y1, ..., yn), t0 < t < t1
+ *          :
+ *      yn' = fn(t, y1, ..., yn), t0 < t < t1
+ *
+ * From the initial conditions:
+ *
+ *      y1(t0), ..., yn(t0)
+ *
+ * @param f the vector of functions {f1, ..., fn}.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the number of functions and initial
+ *         conditions does not match.
+ */
+TrapezoidalStatus trapezoidalMethod(const std::vector<funcn> &f, Trajectory &trajectory, const std::vector<double> &y0,
+                                    double t0, double t1);
+
+
+/**
+ * The number of slope vectors a `StepperWorkspace` needs for `trapezoidalStep`.
+ */
+constexpr std::size_t TRAPEZOIDAL_STAGES = HEUN_TABLEAU.stages;
+
+
+/**
+ * Takes a single step of the trapezoidal method for the system y' = f(t, y), using `explicitRungeKuttaStep` with
+ * `HEUN_TABLEAU`.
+ * @param f the system, called as `f(t, y, dydt)`.
+ * @param m the dimension of the system.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param yNext the array to store the state at `t + h` in. It must not alias `y`.
+ * @param workspace scratch storage, already sized for `m` and `TRAPEZOIDAL_STAGES`.
+ */
+template <OdeSystem System>
+void trapezoidalStep(System &f, std::size_t m, double t, const double *y, double h, double *yNext,
+                     StepperWorkspace &workspace) {
+    explicitRungeKuttaStep<HEUN_TABLEAU>(f, m, t, y, h, yNext, workspace);
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0. The whole derivative vector is computed by a single call to `f`, so
+ * work shared between components is only done once per stage.
+ *
+ * All scratch vectors come from `workspace` and every row of `y` is sized before the time loop, so no allocation
+ * happens while stepping. Passing the same workspace (and result vectors) to later calls avoids allocation entirely.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param t the vector to store the time index in.
+ * @param y the vector to store the result in.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+TrapezoidalStatus trapezoidalMethod(System &&f, std::vector<double> &t, std::vector<std::vector<double>> &y,
+                                    const std::vector<double> &y0, double t0, double t1,
+                                    StepperWorkspace &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) y.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(m, TRAPEZOIDAL_STAGES);
+    for (auto &entry : y) {
+        entry.resize(m);
+    }
+
+    // Initial conditions.
+    t[0] = t0;
+    y[0] = y0;
+
+    for (auto i = 0; i < n - 1; i++) {
+        trapezoidalStep(f, m, t[i], y[i].data(), h, y[i + 1].data(), workspace);
+        t[i + 1] = t[i] + h;
+    }
+
+    return TRAPEZOIDAL_STATUS_OK;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param t the vector to store the time index in.
+ * @param y the vector to store the result in.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+TrapezoidalStatus trapezoidalMethod(System &&f, std::vector<double> &t, std::vector<std::vector<double>> &y,
+                                    const std::vector<double> &y0, double t0, double t1) {
+    StepperWorkspace workspace;
+    return trapezoidalMethod(f, t, y, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, writing every state straight into the contiguous storage of
+ * `trajectory`.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to the dimension of the system.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+TrapezoidalStatus trapezoidalMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                    double t1, StepperWorkspace &workspace) {
+    // m is the number of systems and n is the number of time steps.
+    auto m = y0.size();
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    workspace.resize(m, TRAPEZOIDAL_STAGES);
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, m);
+
+    // Initial conditions.
+    trajectory.time(0) = t0;
+    std::copy(y0.begin(), y0.end(), trajectory.row(0).begin());
+
+    for (auto i = 0; i < n - 1; i++) {
+        trapezoidalStep(f, m, trajectory.time(i), trajectory.row(i).data(), h, trajectory.row(i + 1).data(),
+                        workspace);
+        trajectory.time(i + 1) = trajectory.time(i) + h;
+    }
+
+    return TRAPEZOIDAL_STATUS_OK;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points).
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System>
+TrapezoidalStatus trapezoidalMethod(System &&f, Trajectory &trajectory, const std::vector<double> &y0, double t0,
+                                    double t1) {
+    StepperWorkspace workspace;
+    return trapezoidalMethod(f, trajectory, y0, t0, t1, workspace);
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer` instead of storing them. Only the
+ * current and the next state are kept, so long runs need memory proportional to the dimension of the system only.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System, SolverObserver Observer>
+TrapezoidalStatus trapezoidalMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                    Observer &&observer, int every, StepperWorkspace &workspace) {
+    auto m = y0.size();
+
+    // Two extra stages hold the current and the next state.
+    workspace.resize(m, TRAPEZOIDAL_STAGES + 2);
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        trapezoidalStep(f, m, t, y, h, yNext, workspace);
+        return true;
+    };
+    integrateFixedSteps(step, y0, t0, t1, n, observer, every, workspace.stage(TRAPEZOIDAL_STAGES),
+                        workspace.stage(TRAPEZOIDAL_STAGES + 1));
+
+    return TRAPEZOIDAL_STATUS_OK;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer`, using a temporary workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `y0.size()`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <OdeSystem System, SolverObserver Observer>
+TrapezoidalStatus trapezoidalMethod(System &&f, const std::vector<double> &y0, double t0, double t1, int n,
+                                    Observer &&observer, int every = 1) {
+    StepperWorkspace workspace;
+    return trapezoidalMethod(f, y0, t0, t1, n, observer, every, workspace);
+}
+
+
+/**
+ * Takes a single step of the trapezoidal method for a system of fixed dimension `N`, using `explicitRungeKuttaStep`
+ * with `HEUN_TABLEAU`.
+ *
+ * The dimension is known at compile time, so the loops can be fully unrolled and the state kept in registers, with
+ * `f` inlined into the step.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @return the state at `t + h`.
+ */
+template <std::size_t N, OdeSystem System>
+std::array<double, N> trapezoidalStep(System &f, double t, const std::array<double, N> &y, double h) {
+    return explicitRungeKuttaStep<HEUN_TABLEAU>(f, t, y, h);
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of fixed dimension `N` of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0. This is the same method as the runtime-dimension overloads, but the
+ * state is a `std::array`, so each step is specialized for the dimension. Systems whose dimension is only known at
+ * run time (such as `ExpressionSystem`) use the `std::vector` overloads.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param trajectory the trajectory to store the result in (must have the correct number of time points). It is
+ *        switched to row-major layout and sized to `N`.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @return STATUS_OK.
+ */
+template <std::size_t N, OdeSystem System>
+TrapezoidalStatus trapezoidalMethod(System &&f, Trajectory &trajectory, const std::array<double, N> &y0, double t0,
+                                    double t1) {
+    auto n = (int) trajectory.size();
+    auto h = (t1 - t0) / (n - 1);
+
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(n, N);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    trajectory.time(0) = t;
+    std::copy(y.begin(), y.end(), trajectory.row(0).begin());
+
+    for (auto i = 0; i < n - 1; i++) {
+        y = trapezoidalStep(f, t, y, h);
+        t += h;
+        trajectory.time(i + 1) = t;
+        std::copy(y.begin(), y.end(), trajectory.row(i + 1).begin());
+    }
+
+    return TRAPEZOIDAL_STATUS_OK;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of fixed dimension `N` of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition vector y(t0) = y0, passing the states to `observer` instead of storing them.
+ *
+ * @param f the system, called as `f(t, y, dydt)` with arrays of `N` entries.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @return STATUS_OK.
+ */
+template <std::size_t N, OdeSystem System, SolverObserver Observer>
+TrapezoidalStatus trapezoidalMethod(System &&f, const std::array<double, N> &y0, double t0, double t1, int n,
+                                    Observer &&observer, int every = 1) {
+    auto h = (t1 - t0) / (n - 1);
+
+    // Initial conditions.
+    auto t = t0;
+    auto y = y0;
+    if (shouldObserve(0, n == 1, every) && !observe(observer, t, y.data())) return TRAPEZOIDAL_STATUS_OK;
+
+    for (auto i = 0; i < n - 1; i++) {
+        y = trapezoidalStep(f, t, y, h);
+        t += h;
+        if (shouldObserve(i + 1, i + 1 == n - 1, every) && !observe(observer, t, y.data())) break;
+    }
+
+    return TRAPEZOIDAL_STATUS_OK;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with its fixed step size, passing the states to `observer`. The checkpoint is advanced
+ * in place and written to `options.filename` every `options.every` steps and at the end, so an interrupted run can be
+ * resumed from the last file written, and a finished one extended to a later `t1`, with exactly the same results as
+ * an uninterrupted run.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0, h)` to start from the initial conditions.
+ * @param t1 the final time. The number of steps is `(t1 - checkpoint.t) / checkpoint.h`, rounded to the nearest
+ *        integer.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th state (and the final one), counted from the initial conditions, or only the
+ *        final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @param workspace the scratch storage to use. It is resized as needed.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_CHECKPOINT_FAILED if the checkpoint was recorded by another
+ *         method or has no step size, or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+TrapezoidalStatus trapezoidalMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer, int every,
+                                    const CheckpointOptions &options, StepperWorkspace &workspace) {
+    auto m = checkpoint.y.size();
+
+    // Two extra stages hold the current and the next state.
+    workspace.resize(m, TRAPEZOIDAL_STAGES + 2);
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        trapezoidalStep(f, m, t, y, h, yNext, workspace);
+        return true;
+    };
+    auto completed = integrateFixedSteps(step, checkpoint, HEUN_TABLEAU.order, butcherTableauId(HEUN_TABLEAU), t1,
+                                         observer, every, options, workspace.stage(TRAPEZOIDAL_STAGES),
+                                         workspace.stage(TRAPEZOIDAL_STAGES + 1));
+
+    return completed ? TRAPEZOIDAL_STATUS_OK : TRAPEZOIDAL_STATUS_ERROR_CHECKPOINT_FAILED;
+}
+
+
+/**
+ * Uses the trapezoidal method to solve a system of ODEs of the form:
+ *
+ *      y' = f(t, y), t < t1
+ *
+ * Continuing from `checkpoint` with its fixed step size, passing the states to `observer`, using a temporary
+ * workspace.
+ *
+ * @param f the system, called as `f(t, y, dydt)`. The dimension of the system is `checkpoint.y.size()`.
+ * @param checkpoint the state to continue from, such as `Checkpoint(y0, t0, h)` to start from the initial conditions.
+ * @param t1 the final time.
+ * @param observer the observer, called as `observer(t, y)`. States observed before the checkpoint are not repeated.
+ * @param every observe every `every`-th state (and the final one), counted from the initial conditions, or only the
+ *        final state for `OBSERVE_FINAL_STATE_ONLY`.
+ * @param options where and how often to write the checkpoint.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_CHECKPOINT_FAILED if the checkpoint was recorded by another
+ *         method or has no step size, or if writing it failed.
+ */
+template <OdeSystem System, SolverObserver Observer>
+TrapezoidalStatus trapezoidalMethod(System &&f, Checkpoint &checkpoint, double t1, Observer &&observer, int every = 1,
+                                    const CheckpointOptions &options = {}) {
+    StepperWorkspace workspace;
+    return trapezoidalMethod(f, checkpoint, t1, observer, every, options, workspace);
+}
+
 #endif // CHAPTER_6_TRAPEZOIDAL_METHOD_H
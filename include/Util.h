@@ -3,8 +3,11 @@
 #define CHAPTER_6_UTIL_H
 
 #include <ostream>
+#include <span>
 #include <vector>
 
+#include "Trajectory.h"
+
 
 /**
  * Output a vector of doubles to a stream.
@@ -14,4 +17,21 @@
  */
 std::ostream &operator<<(std::ostream &stream, const std::vector<double> &vector);
 
+/**
+ * Output a span of doubles (such as a row or column of a `Trajectory`) to a stream.
+ * @param stream the stream to write to.
+ * @param values the doubles to write.
+ * @return the stream.
+ */
+std::ostream &operator<<(std::ostream &stream, std::span<const double> values);
+
+/**
+ * Output a trajectory to a stream, one line of the form `t, y1, ..., yn` per time point. Values are written with the
+ * shortest round-trip formatting through a `CsvWriter`, and the stream is not flushed.
+ * @param stream the stream to write to.
+ * @param trajectory the trajectory to write.
+ * @return the stream.
+ */
+std::ostream &operator<<(std::ostream &stream, const Trajectory &trajectory);
+
 #endif // CHAPTER_6_UTIL_H
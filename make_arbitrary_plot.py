@@ -1,18 +1,22 @@
+import os
+import sys
+
 import matplotlib.pyplot as plt
-import numpy as np
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), 'output'))
+import trajectory_file  # noqa: E402
 
 
 def main():
-    data = np.loadtxt('output.txt', delimiter=',')
-    t = data[:, 0]
-    y = data[:, 1:]
+    path = sys.argv[1] if len(sys.argv) > 1 else 'output.txt'
+    t, y = trajectory_file.load(path)
 
     plt.figure()
     plt.plot(t, y)
     plt.title('Component-wise Solution Plot')
     plt.xlabel('$t$')
     plt.ylabel('$y$')
-    plt.legend([f'$y_{i}$' for i in range(1, data.shape[1])])
+    plt.legend([f'$y_{i}$' for i in range(1, y.shape[1] + 1)])
     plt.grid(True)
     plt.show()
 
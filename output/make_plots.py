@@ -4,11 +4,11 @@ import glob
 import matplotlib.pyplot as plt
 import numpy as np
 
+import trajectory_file
+
 
 def make_plot(path: str) -> tuple:
-    data = np.loadtxt(path, delimiter=',')
-    t = data[:, 0]
-    y = data[:, 1:]
+    t, y = trajectory_file.load(path)
 
     # Time domain plot.
     plt.figure()
@@ -64,7 +64,7 @@ def make_plot(path: str) -> tuple:
 def main():
     labels = []
     orbits = []
-    for path in glob.glob('*.txt'):
+    for path in glob.glob('*.txt') + glob.glob('*.bin'):
         labels.append(os.path.basename(path)[:-4].replace('_', ' '))
         orbits.append(make_plot(path))
 
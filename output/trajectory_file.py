@@ -0,0 +1,55 @@
+import numpy as np
+
+# Layout of the 64 byte header written by `writeTrajectory` (see include/TrajectoryFile.h).
+HEADER = np.dtype([
+    ('magic', 'S8'),
+    ('version', '<u4'),
+    ('type', '<u4'),
+    ('time_layout', '<u4'),
+    ('reserved', '<u4'),
+    ('dimension', '<u8'),
+    ('count', '<u8'),
+    ('t0', '<f8'),
+    ('h', '<f8'),
+    ('padding', 'S8'),
+])
+
+MAGIC = b'C6TRAJ'
+TYPES = {1: '<f8', 2: '<f4'}
+TIME_LAYOUT_COLUMN = 0
+TIME_LAYOUT_UNIFORM = 1
+
+
+def is_binary(path: str) -> bool:
+    with open(path, 'rb') as file:
+        return file.read(len(MAGIC)) == MAGIC
+
+
+def load(path: str) -> tuple:
+    """
+    Load a trajectory written by the solvers, in either the CSV or the binary format.
+
+    Binary files are memory-mapped rather than parsed, so `y` is a read-only view of the file.
+
+    :param path: the file to load.
+    :return: the time points `t`, of shape (count,), and the states `y`, of shape (count, dimension).
+    """
+    if not is_binary(path):
+        data = np.loadtxt(path, delimiter=',', ndmin=2)
+        return data[:, 0], data[:, 1:]
+
+    header = np.fromfile(path, dtype=HEADER, count=1)[0]
+    if header['version'] != 1 or header['type'] not in TYPES:
+        raise ValueError(f'{path}: unsupported trajectory file')
+
+    count = int(header['count'])
+    dimension = int(header['dimension'])
+    columns = dimension + (1 if header['time_layout'] == TIME_LAYOUT_COLUMN else 0)
+    if count == 0:
+        return np.zeros(0), np.zeros((0, dimension))
+
+    data = np.memmap(path, dtype=TYPES[int(header['type'])], mode='r', offset=HEADER.itemsize,
+                     shape=(count, columns))
+    if header['time_layout'] == TIME_LAYOUT_COLUMN:
+        return data[:, 0], data[:, 1:]
+    return header['t0'] + header['h'] * np.arange(count), data
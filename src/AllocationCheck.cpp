@@ -0,0 +1,115 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "RungeKuttaMethod.h"
+#include "StepperWorkspace.h"
+#include "Trajectory.h"
+#include "TrapezoidalMethod.h"
+
+
+// Every allocation made through the global operator new is counted, so the check can tell whether a solver call
+// touched the heap.
+static std::size_t allocationCount = 0;
+
+void *operator new(std::size_t size) {
+    allocationCount++;
+    if (auto pointer = std::malloc(size > 0 ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+// Each solver is run this many times after the first, which sizes the workspace and the results.
+const auto repetitions = 10;
+
+
+/**
+ * Runs `run` once to size its storage, then `repetitions` more times, and reports the allocations of the repeated
+ * runs.
+ * @return true if the repeated runs did not allocate.
+ */
+template <typename Run>
+bool check(const std::string &name, Run &&run) {
+    run();
+
+    auto allocations = allocationCount;
+    for (auto repetition = 0; repetition < repetitions; repetition++) {
+        run();
+    }
+    allocations = allocationCount - allocations;
+
+    std::cout << (allocations == 0 ? "ok      " : "FAILED  ") << name << ": " << allocations << " allocations in "
+              << repetitions << " repeated runs" << std::endl;
+    return allocations == 0;
+}
+
+
+/**
+ * Checks that the explicit solvers make no allocation once their `StepperWorkspace` and result storage have been
+ * sized by a first run, whatever form the result takes.
+ * @return EXIT_SUCCESS if no repeated run allocated, EXIT_FAILURE otherwise.
+ */
+int main() {
+    // The pendulum of the Chapter6 demo.
+    auto f = [](double t, const double *y, double *dydt) {
+        dydt[0] = y[1];
+        dydt[1] = -9.81 * sin(y[0]) - 0.1 * y[1];
+    };
+    const std::vector<double> y0({1, 0});
+    const auto n = 1000;
+
+    StepperWorkspace workspace;
+    std::vector<double> t(n);
+    std::vector<std::vector<double>> y(n);
+    Trajectory trajectory(n, y0.size());
+    auto sum = 0.0;
+    auto observer = [&](double t, const double *y) { sum += y[0]; };
+
+    auto ok = true;
+    ok &= check("trapezoidalMethod (vectors)", [&] {
+        trapezoidalMethod(f, t, y, y0, 0, 10, workspace);
+    });
+    ok &= check("trapezoidalMethod (trajectory)", [&] {
+        trapezoidalMethod(f, trajectory, y0, 0, 10, workspace);
+    });
+    ok &= check("trapezoidalMethod (observer)", [&] {
+        trapezoidalMethod(f, y0, 0, 10, n, observer, 1, workspace);
+    });
+    ok &= check("rungeKuttaMethod (vectors)", [&] {
+        rungeKuttaMethod(f, t, y, y0, 0, 10, workspace);
+    });
+    ok &= check("rungeKuttaMethod (trajectory)", [&] {
+        rungeKuttaMethod(f, trajectory, y0, 0, 10, workspace);
+    });
+    ok &= check("rungeKuttaMethod (observer)", [&] {
+        rungeKuttaMethod(f, y0, 0, 10, n, observer, 1, workspace);
+    });
+    ok &= check("explicitRungeKuttaMethod<THREE_EIGHTHS_RULE_TABLEAU> (trajectory)", [&] {
+        explicitRungeKuttaMethod<THREE_EIGHTHS_RULE_TABLEAU>(f, trajectory, y0, 0, 10, workspace);
+    });
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
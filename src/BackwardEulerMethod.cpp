@@ -4,6 +4,165 @@
 #include "BackwardEulerMethod.h"
 
 
+/**
+ * What the scalar backward Euler method keeps from one step to the next: the derivative of `f` with respect to `y`
+ * and the slope at the end of the last step (see `NewtonWorkspace`).
+ */
+struct ScalarNewtonState {
+    double derivative = 0;
+    bool derivativeValid = false;
+
+    double slope = 0;
+    bool slopeValid = false;
+};
+
+
+/**
+ * Makes a single attempt at solving
+ *
+ *      z - y - h f(t + h, z) = 0
+ *
+ * for z with simplified Newton's method: the derivative `fy` is reused across iterations and steps for as long as the
+ * updates shrink by at least `BACKWARD_EULER_SLOW_CONVERGENCE` per iteration, and only re-evaluated when they do not,
+ * at the current iterate, or at the previous one if the update diverged. The iteration starts from the linearly
+ * implicit Euler prediction
+ *
+ *      z = y + h f(t, y) / (1 - h fy)
+ *
+ * where f(t, y) is the slope at the end of the last step, so the prediction costs no evaluations. An update that is
+ * not finite fails the attempt.
+ *
+ * @param f the function `f`.
+ * @param fy partial derivative of `f` with respect to `y`.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param z the variable to store the state at `t + h` in.
+ * @param tolerance the tolerance for Newton's method.
+ * @param maxIterations the maximum number of iterations for Newton's method.
+ * @param state what is kept from the previous steps.
+ * @param stats if not null, the statistics to record the evaluations and Newton iterations of the attempt in.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge.
+ */
+static EulerStatus backwardEulerAttempt(const func1 &f, const func1 &fy, double t, double y, double h, double &z,
+                                        double tolerance, int maxIterations, ScalarNewtonState &state,
+                                        SolverStats *stats) {
+    // Whether the derivative was evaluated at the iterate the next update starts from, so re-evaluating it cannot help.
+    auto current = false;
+    auto evaluateDerivative = [&] {
+        state.derivative = stats ? measureOperation(*stats, stats->jacobian, [&] { return fy(t, z); }) : fy(t, z);
+        state.derivativeValid = true;
+        current = true;
+    };
+
+    t += h;
+    z = y;
+    if (!state.derivativeValid) evaluateDerivative();
+    if (state.slopeValid) z += h * state.slope / (1 - h * state.derivative);
+
+    // Newton loop
+    auto status = EULER_STATUS_OK;
+    auto iterations = 0;
+    auto delta = std::numeric_limits<double>::infinity();
+    auto previousDelta = delta;
+    while (fabs(delta) > tolerance) {
+        if (iterations >= maxIterations) {
+            status = EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE;
+            break;
+        }
+
+        auto value = stats ? measureOperation(*stats, stats->rhs, [&] { return f(t, z); }) : f(t, z);
+        delta = -(z - h * value - y) / (1 - h * state.derivative);
+        z += delta;
+        iterations++;
+
+        // A NaN or infinite update, from `f`, `fy` or a vanishing denominator, would otherwise pass for convergence.
+        if (!std::isfinite(delta)) {
+            status = EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE;
+            break;
+        }
+
+        auto updatedWithCurrent = current;
+        current = false;
+        if (fabs(delta) > tolerance && fabs(delta) > BACKWARD_EULER_SLOW_CONVERGENCE * previousDelta &&
+            !updatedWithCurrent) {
+            if (fabs(delta) >= previousDelta) {
+                // Diverging, which an outdated derivative can do far from the solution: undo the update and continue
+                // from the previous iterate with the derivative evaluated there, as Newton's method would.
+                z -= delta;
+                delta = previousDelta;
+            }
+            evaluateDerivative();
+        }
+        previousDelta = fabs(delta);
+    }
+
+    if (status == EULER_STATUS_OK) {
+        state.slope = (z - y) / h;
+        state.slopeValid = true;
+    }
+    else {
+        // Start the retry from a fresh derivative.
+        state.derivativeValid = false;
+    }
+
+    if (stats) {
+        stats->steps++;
+        if (status != EULER_STATUS_OK) stats->rejectedSteps++;
+        stats->recordNewtonSolve(iterations, status == EULER_STATUS_OK);
+    }
+    return status;
+}
+
+
+/**
+ * Takes a single step of the backward Euler method for the ODE y' = f(t, y) with `backwardEulerAttempt`. If Newton's
+ * method fails to converge, the step is halved and the interval covered by substeps instead, halving again on any
+ * further failure, up to `BACKWARD_EULER_MAX_HALVINGS` times.
+ *
+ * @param f the function `f`.
+ * @param fy partial derivative of `f` with respect to `y`.
+ * @param t the time at the start of the step.
+ * @param y the state at the start of the step.
+ * @param h the step size.
+ * @param z the variable to store the state at `t + h` in.
+ * @param tolerance the tolerance for Newton's method.
+ * @param maxIterations the maximum number of iterations of each Newton solve.
+ * @param state what is kept from the previous steps.
+ * @param stats if not null, the statistics to record the evaluations and Newton iterations of the step in.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps.
+ */
+static EulerStatus backwardEulerStep(const func1 &f, const func1 &fy, double t, double y, double h, double &z,
+                                     double tolerance, int maxIterations, ScalarNewtonState &state,
+                                     SolverStats *stats) {
+    auto status = backwardEulerAttempt(f, fy, t, y, h, z, tolerance, maxIterations, state, stats);
+    if (status == EULER_STATUS_OK) return status;
+
+    // Cover the step with 2^halvings substeps, of which `done` are taken, starting from `start`.
+    auto start = y;
+    auto halvings = 0;
+    long substeps = 1;
+    long done = 0;
+    while (done < substeps) {
+        if (status != EULER_STATUS_OK) {
+            if (halvings == BACKWARD_EULER_MAX_HALVINGS) return status;
+            halvings++;
+            substeps *= 2;
+            done *= 2;
+        }
+
+        status = backwardEulerAttempt(f, fy, t + done * (h / substeps), start, h / substeps, z, tolerance,
+                                      maxIterations, state, stats);
+        if (status == EULER_STATUS_OK) {
+            start = z;
+            done++;
+        }
+    }
+    return status;
+}
+
+
 /**
  * Uses the backward Euler method to solve an ODE of the form:
  *
@@ -13,6 +172,10 @@
  *
  *      y(t0) = y0
  *
+ * Each step is solved with simplified Newton's method, which keeps `fy` from earlier iterations and steps until
+ * convergence slows, starting from a prediction from the previous step. A step whose iteration fails to converge is
+ * retried as two half steps, up to `BACKWARD_EULER_MAX_HALVINGS` times.
+ *
  * @param f the function `f`. The first argument corresponds to t and second to y.
  * @param fy partial derivative of `f` with respect to `y`. The first argument corresponds to t and second to y.
  * @param t vector to store time index (must have correct size).
@@ -21,28 +184,64 @@
  * @param t0 initial time.
  * @param t1 final time.
  * @param tolerance the tolerance for Newton's method.
- * @param maxIterations the maximum number of iterations for Newton's method.
- * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param stats if not null, the statistics to add the evaluations, steps and Newton iterations of the run to.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps.
  */
 EulerStatus backwardEulerMethod(const func1 &f, const func1 &fy, std::vector<double> &t, std::vector<double> &y,
-                                 double y0, double t0, double t1, double tolerance, int maxIterations) {
+                                 double y0, double t0, double t1, double tolerance, int maxIterations,
+                                 SolverStats *stats) {
     auto n = (int) y.size();
     auto h = (t1 - t0) / (n - 1);
 
     t[0] = t0;
     y[0] = y0;
 
+    ScalarNewtonState state;
     for (auto i = 0; i < n - 1; i++) {
         t[i + 1] = t[i] + h;
 
-        // Newton loop
-        y[i + 1] = y[i];
-        auto delta = std::numeric_limits<double>::infinity();
-        for(auto iteration = 0; fabs(delta) > tolerance; iteration++) {
-            delta = -(y[i + 1] - h * f(t[i + 1], y[i + 1]) - y[i]) / (1 - h * fy(t[i + 1], y[i + 1]));
-            y[i + 1] += delta;
-            if (iteration >= maxIterations) return EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE;
-        }
+        auto status = backwardEulerStep(f, fy, t[i], y[i], h, y[i + 1], tolerance, maxIterations, state, stats);
+        if (status != EULER_STATUS_OK) return status;
     }
     return EULER_STATUS_OK;
 }
+
+
+/**
+ * Uses the backward Euler method to solve an ODE of the form:
+ *
+ *      y' = f(t, y), t0 < t < t1
+ *
+ * From the initial condition y(t0) = y0, passing the states to `observer` instead of storing them.
+ *
+ * @param f the function `f`. The first argument corresponds to t and second to y.
+ * @param fy partial derivative of `f` with respect to `y`. The first argument corresponds to t and second to y.
+ * @param y0 initial condition.
+ * @param t0 initial time.
+ * @param t1 final time.
+ * @param n the number of time points, including the initial one.
+ * @param observer the observer, called as `observer(t, &y)`.
+ * @param every observe every `every`-th state (and the final one), or only the final state for
+ *        `OBSERVE_FINAL_STATE_ONLY`.
+ * @param tolerance the tolerance for Newton's method.
+ * @param maxIterations the maximum number of iterations of each Newton solve before the step is halved.
+ * @param stats if not null, the statistics to add the evaluations, steps and Newton iterations of the run to.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE if Newton's method fails to converge
+ *         even on the smallest substeps.
+ */
+EulerStatus backwardEulerMethod(const func1 &f, const func1 &fy, double y0, double t0, double t1, int n,
+                                const observern &observer, int every, double tolerance, int maxIterations,
+                                SolverStats *stats) {
+    double states[2];
+    ScalarNewtonState state;
+    auto status = EULER_STATUS_OK;
+    auto step = [&](double t, const double *y, double h, double *yNext) {
+        status = backwardEulerStep(f, fy, t, *y, h, *yNext, tolerance, maxIterations, state, stats);
+        return status == EULER_STATUS_OK;
+    };
+    integrateFixedSteps(step, {y0}, t0, t1, n, observer, every, &states[0], &states[1]);
+
+    return status;
+}
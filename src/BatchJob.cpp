@@ -0,0 +1,431 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "BackwardEulerMethod.h"
+#include "BatchJob.h"
+#include "DormandPrinceMethod.h"
+#include "ExpressionSystem.h"
+#include "Jacobian.h"
+#include "ParameterSweep.h"
+#include "RungeKuttaMethod.h"
+#include "TrajectoryFile.h"
+#include "TrapezoidalMethod.h"
+
+
+namespace {
+
+const char *methodNames[] = {"backward-euler", "trapezoidal", "rk4", "dormand-prince"};
+const char *systemNames[] = {"expressions", "pendulum", "orbit", "sir"};
+
+// The dimension of each built-in system.
+const std::size_t systemDimensions[] = {0, 2, 4, 3};
+
+const char *parameterNames[] = {"gravity", "length", "drag", "b", "k", "relativeTolerance", "absoluteTolerance",
+                                "tolerance"};
+
+
+std::string trim(const std::string &text) {
+    auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    auto last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+template <std::size_t N>
+bool lookup(const char *(&names)[N], const std::string &name, int &index) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (name == names[i]) {
+            index = (int) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Parse the whole of `text` as a number.
+ */
+template <typename T>
+bool parseNumber(const std::string &text, T &value) {
+    std::istringstream stream(text);
+    stream >> value;
+    return stream && (stream >> std::ws).eof();
+}
+
+double parameter(const BatchJob &job, const std::string &name, double value) {
+    auto found = job.parameters.find(name);
+    return found == job.parameters.end() ? value : found->second;
+}
+
+
+/**
+ * Check the settings of a job once all of its lines are read.
+ * @return an empty string if the job is valid, otherwise the reason it is not.
+ */
+std::string validate(const BatchJob &job) {
+    if (job.system == BATCH_SYSTEM_EXPRESSIONS) {
+        if (job.expressions.empty()) return "no expressions (f = ...) given";
+        if (job.y0.size() != job.expressions.size()) return "y0 needs one value per expression";
+    }
+    else {
+        if (!job.expressions.empty()) return "expressions given for a built-in system";
+        if (job.system != BATCH_SYSTEM_ORBIT && job.y0.size() != systemDimensions[job.system]) {
+            return "y0 needs " + std::to_string(systemDimensions[job.system]) + " values";
+        }
+        if (job.system == BATCH_SYSTEM_ORBIT && !job.y0.empty() && job.y0.size() != 4) return "y0 needs 4 values";
+        if (job.system == BATCH_SYSTEM_SIR && (!job.parameters.count("b") || !job.parameters.count("k"))) {
+            return "the SIR model needs the parameters b and k";
+        }
+        // The model is solved for the fractions of the population, y0 divided by its total.
+        if (job.system == BATCH_SYSTEM_SIR && !(job.y0[0] + job.y0[1] + job.y0[2] > 0)) {
+            return "the SIR population (the sum of y0) must be positive";
+        }
+    }
+    if (job.n < 2) return "n must be at least 2";
+    if (!(job.t1 > job.t0)) return "t1 must be greater than t0";
+    return "";
+}
+
+
+/**
+ * Hands out compiled expression systems. A system is used by one job at a time, since it evaluates into storage of its
+ * own, and goes back to the cache when the job is done, so later jobs with the same expressions skip compiling them.
+ */
+class ExpressionCache {
+public:
+    /**
+     * @param reused set to whether the system came from the cache rather than being compiled.
+     * @return a system compiled from `expressions`, or null if they do not compile (see `error`).
+     */
+    std::unique_ptr<ExpressionSystem> acquire(const std::vector<std::string> &expressions, bool &reused,
+                                              std::string &error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &systems = idle[expressions];
+            reused = !systems.empty();
+            if (reused) {
+                auto system = std::move(systems.back());
+                systems.pop_back();
+                return system;
+            }
+        }
+
+        // Compile outside the lock, so jobs with other expressions are not held up.
+        auto system = std::make_unique<ExpressionSystem>();
+        if (system->compile(expressions) != EXPRESSION_STATUS_OK) {
+            error = system->error();
+            return nullptr;
+        }
+        return system;
+    }
+
+    void release(const std::vector<std::string> &expressions, std::unique_ptr<ExpressionSystem> system) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle[expressions].push_back(std::move(system));
+    }
+
+private:
+    std::mutex mutex;
+    std::map<std::vector<std::string>, std::vector<std::unique_ptr<ExpressionSystem>>> idle;
+};
+
+
+/**
+ * Solve a job's system with its method and store the result in `trajectory`.
+ * @param f the system.
+ * @param y0 the initial conditions.
+ * @return an empty string if the solver succeeds, otherwise the reason it failed.
+ */
+template <OdeSystem System>
+std::string solve(const BatchJob &job, System &f, const std::vector<double> &y0, Trajectory &trajectory) {
+    auto m = y0.size();
+    trajectory.resize(job.n, m);
+
+    switch (job.method) {
+        case BATCH_METHOD_BACKWARD_EULER: {
+            FiniteDifferenceJacobian<System> fy(f, m);
+            auto result = backwardEulerMethod(f, fy, trajectory, y0, job.t0, job.t1, parameter(job, "tolerance", 1e-6));
+            if (result == EULER_STATUS_ERROR_NEWTON_FAILS_TO_CONVERGE) return "Newton iteration did not converge";
+            if (result != EULER_STATUS_OK) return "singular Newton iteration matrix";
+            break;
+        }
+        case BATCH_METHOD_TRAPEZOIDAL:
+            if (trapezoidalMethod(f, trajectory, y0, job.t0, job.t1) != TRAPEZOIDAL_STATUS_OK) {
+                return "dimension mismatch";
+            }
+            break;
+        case BATCH_METHOD_RUNGE_KUTTA:
+            if (rungeKuttaMethod(f, trajectory, y0, job.t0, job.t1) != RUNGE_KUTTA_STATUS_OK) {
+                return "dimension mismatch";
+            }
+            break;
+        case BATCH_METHOD_DORMAND_PRINCE: {
+            DormandPrinceOptions options;
+            options.relativeTolerance = parameter(job, "relativeTolerance", options.relativeTolerance);
+            options.absoluteTolerance = parameter(job, "absoluteTolerance", options.absoluteTolerance);
+            auto result = dormandPrinceMethod(f, trajectory, y0, job.t0, job.t1, options);
+            if (result == DORMAND_PRINCE_STATUS_ERROR_STEP_SIZE_TOO_SMALL) return "step size too small";
+            if (result != DORMAND_PRINCE_STATUS_OK) return "too many steps";
+            break;
+        }
+    }
+    return "";
+}
+
+
+BatchJobResult runBatchJob(const BatchJob &job, ExpressionCache &cache) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    BatchJobResult result;
+    Trajectory trajectory;
+    std::string failure;
+
+    // Time only the solver, not setting up the system.
+    auto timed = [&](auto &f, const std::vector<double> &y0) {
+        auto solverStart = Clock::now();
+        failure = solve(job, f, y0, trajectory);
+        result.solverSeconds = std::chrono::duration<double>(Clock::now() - solverStart).count();
+    };
+
+    switch (job.system) {
+        case BATCH_SYSTEM_EXPRESSIONS: {
+            std::string error;
+            auto system = cache.acquire(job.expressions, result.reusedExpressions, error);
+            if (!system) {
+                result.status = BATCH_STATUS_ERROR_PARSE_FAILED;
+                result.message = "unable to parse expression " + error;
+                break;
+            }
+            auto f = [&system](double t, const double *y, double *dydt) { (*system)(t, y, dydt); };
+            timed(f, job.y0);
+            cache.release(job.expressions, std::move(system));
+            break;
+        }
+        case BATCH_SYSTEM_PENDULUM: {
+            auto gravity = parameter(job, "gravity", 9.81);
+            auto length = parameter(job, "length", 1.0);
+            auto drag = parameter(job, "drag", 0.0);
+            auto f = [=](double t, const double *y, double *dydt) {
+                dydt[0] = y[1];
+                dydt[1] = -(gravity / length) * sin(y[0]) - drag * y[1];
+            };
+            timed(f, job.y0);
+            break;
+        }
+        case BATCH_SYSTEM_ORBIT: {
+            const auto gravitationalConstant = 6.674e-11;
+            const auto earthMass = 5.97e24;
+            auto f = [=](double t, const double *y, double *dydt) {
+                auto radius = sqrt(pow(y[0], 2) + pow(y[1], 2));
+                auto acceleration = -gravitationalConstant * earthMass / pow(radius, 2);
+                dydt[0] = y[2];
+                dydt[1] = y[3];
+                dydt[2] = acceleration * y[0] / radius;
+                dydt[3] = acceleration * y[1] / radius;
+            };
+            timed(f, job.y0.empty() ? std::vector<double>({0, 3.577e8, 1023, 0}) : job.y0);
+            break;
+        }
+        case BATCH_SYSTEM_SIR: {
+            auto b = parameter(job, "b", 0);
+            auto k = parameter(job, "k", 0);
+            auto f = [=](double t, const double *y, double *dydt) {
+                auto infections = b * y[0] * y[1];
+                auto recoveries = k * y[1];
+                dydt[0] = -infections;
+                dydt[1] = infections - recoveries;
+                dydt[2] = recoveries;
+            };
+
+            // Solve for the fractions of the population, as the interactive demo does, and undo the normalization.
+            auto total = job.y0[0] + job.y0[1] + job.y0[2];
+            timed(f, {job.y0[0] / total, job.y0[1] / total, job.y0[2] / total});
+            for (double &value : trajectory.data()) {
+                value *= total;
+            }
+            break;
+        }
+    }
+
+    if (result.status == BATCH_STATUS_OK && !failure.empty()) {
+        result.status = BATCH_STATUS_ERROR_SOLVER_FAILED;
+        result.message = failure;
+    }
+    result.points = trajectory.size();
+
+    // A failed run still writes the steps it completed, which helps to see where it went wrong.
+    if (result.status != BATCH_STATUS_ERROR_PARSE_FAILED && !job.output.empty() &&
+        writeTrajectory(job.output, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        result.status = BATCH_STATUS_ERROR_WRITE_FAILED;
+        result.message = "unable to write file " + job.output;
+    }
+
+    result.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+} // namespace
+
+
+/**
+ * Read the jobs of a batch from a stream. Jobs are sections started by a `[name]` line, followed by one `key = value`
+ * line per setting (see the header for the format).
+ * @param stream the stream to read from.
+ * @param jobs the vector to append the jobs to.
+ * @param error a description of the first invalid line, if any.
+ * @return STATUS_OK if every job is valid, STATUS_ERROR_INVALID_JOB otherwise.
+ */
+BatchStatus readBatchJobs(std::istream &stream, std::vector<BatchJob> &jobs, std::string &error) {
+    auto first = jobs.size();
+    auto fail = [&](int line, const std::string &reason) {
+        error = "line " + std::to_string(line) + ": " + reason;
+        jobs.resize(first);
+        return BATCH_STATUS_ERROR_INVALID_JOB;
+    };
+    auto finish = [&]() {
+        return jobs.size() == first ? std::string() : validate(jobs.back());
+    };
+
+    std::string text;
+    for (auto line = 1; std::getline(stream, text); line++) {
+        text = trim(text);
+        if (text.empty() || text[0] == '#') continue;
+
+        if (text.front() == '[') {
+            if (text.back() != ']') return fail(line, "expected ']'");
+            auto reason = finish();
+            if (!reason.empty()) return fail(jobs.back().line, "job " + jobs.back().name + ": " + reason);
+
+            jobs.emplace_back();
+            jobs.back().name = trim(text.substr(1, text.size() - 2));
+            jobs.back().line = line;
+            continue;
+        }
+
+        auto equals = text.find('=');
+        if (equals == std::string::npos) return fail(line, "expected 'key = value'");
+        if (jobs.size() == first) return fail(line, "setting outside of a job, expected '[name]' first");
+
+        auto key = trim(text.substr(0, equals));
+        auto value = trim(text.substr(equals + 1));
+        auto &job = jobs.back();
+        int index;
+        if (key == "method") {
+            if (!lookup(methodNames, value, index)) return fail(line, "unknown method " + value);
+            job.method = static_cast<BatchMethod>(index);
+        }
+        else if (key == "system") {
+            if (!lookup(systemNames, value, index)) return fail(line, "unknown system " + value);
+            job.system = static_cast<BatchSystem>(index);
+        }
+        else if (key == "f") {
+            job.expressions.push_back(value);
+        }
+        else if (key == "y0") {
+            std::istringstream values(value);
+            job.y0.clear();
+            double y;
+            while (values >> y) {
+                job.y0.push_back(y);
+            }
+            if (!(values >> std::ws).eof()) return fail(line, "invalid initial conditions " + value);
+        }
+        else if (key == "output") {
+            job.output = value;
+        }
+        else if (key == "n") {
+            if (!parseNumber(value, job.n)) return fail(line, "invalid number " + value);
+        }
+        else if (key == "t0" || key == "t1") {
+            if (!parseNumber(value, key == "t0" ? job.t0 : job.t1)) return fail(line, "invalid number " + value);
+        }
+        else if (lookup(parameterNames, key, index)) {
+            if (!parseNumber(value, job.parameters[key])) return fail(line, "invalid number " + value);
+        }
+        else {
+            return fail(line, "unknown setting " + key);
+        }
+    }
+
+    auto reason = finish();
+    if (!reason.empty()) return fail(jobs.back().line, "job " + jobs.back().name + ": " + reason);
+    return BATCH_STATUS_OK;
+}
+
+
+/**
+ * Read the jobs of a batch from a file (see `readBatchJobs`).
+ * @param filename the job file to read.
+ * @param jobs the vector to append the jobs to.
+ * @param error a description of the first invalid line, if any.
+ * @return STATUS_OK if every job is valid, STATUS_ERROR_OPEN_FAILED if the file could not be opened or
+ *         STATUS_ERROR_INVALID_JOB otherwise.
+ */
+BatchStatus readBatchJobs(const std::string &filename, std::vector<BatchJob> &jobs, std::string &error) {
+    std::ifstream file(filename, std::ios_base::in);
+    if (!file.is_open()) {
+        error = "unable to open file " + filename;
+        return BATCH_STATUS_ERROR_OPEN_FAILED;
+    }
+    return readBatchJobs(file, jobs, error);
+}
+
+
+/**
+ * Run the jobs of a batch concurrently on a thread pool, sharing compiled expression systems between jobs.
+ * @param pool the thread pool to run on.
+ * @param jobs the jobs to run.
+ * @return the result of each job, in the order of `jobs`.
+ */
+std::vector<BatchJobResult> runBatchJobs(ThreadPool &pool, const std::vector<BatchJob> &jobs) {
+    ExpressionCache cache;
+    return parameterSweep(pool, jobs, [&](std::size_t index, const BatchJob &job) {
+        return runBatchJob(job, cache);
+    });
+}
+
+
+/**
+ * Print one line per job followed by the total time of the jobs and the wall-clock time of the batch.
+ * @param stream the stream to write to.
+ * @param jobs the jobs that were run.
+ * @param results the result of each job.
+ * @param wallSeconds the wall-clock time of the whole batch.
+ */
+void printBatchSummary(std::ostream &stream, const std::vector<BatchJob> &jobs,
+                       const std::vector<BatchJobResult> &results, double wallSeconds) {
+    stream << std::left << std::setw(20) << "job" << std::setw(16) << "method" << std::setw(13) << "system"
+           << std::right << std::setw(10) << "points" << std::setw(13) << "solver [s]" << std::setw(13)
+           << "total [s]" << "  status" << std::endl;
+
+    auto jobSeconds = 0.0;
+    auto failed = 0;
+    for (auto i = 0; i < jobs.size(); i++) {
+        auto &job = jobs[i];
+        auto &result = results[i];
+        jobSeconds += result.totalSeconds;
+
+        stream << std::left << std::setw(20) << job.name << std::setw(16) << methodNames[job.method]
+               << std::setw(13) << systemNames[job.system] << std::right << std::setw(10) << result.points
+               << std::fixed << std::setprecision(4) << std::setw(13) << result.solverSeconds << std::setw(13)
+               << result.totalSeconds << std::defaultfloat << "  ";
+        if (result.status == BATCH_STATUS_OK) {
+            stream << "ok";
+            if (result.reusedExpressions) stream << " (reused expressions)";
+        }
+        else {
+            stream << "failed: " << result.message;
+            failed++;
+        }
+        stream << std::endl;
+    }
+
+    stream << jobs.size() << " jobs, " << failed << " failed. Job time " << std::fixed << std::setprecision(4)
+           << jobSeconds << " s, wall-clock time " << wallSeconds << " s." << std::defaultfloat << std::endl;
+}
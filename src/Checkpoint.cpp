@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "Checkpoint.h"
+
+
+/**
+ * Write a checkpoint to a file. The file is written under a temporary name and then renamed, so a run killed while
+ * writing leaves the previous checkpoint intact.
+ * @param filename the file to write.
+ * @param checkpoint the checkpoint to write.
+ * @return STATUS_OK if the file was written, STATUS_ERROR_OPEN_FAILED if it could not be opened or
+ *         STATUS_ERROR_IO_FAILED if writing failed.
+ */
+CheckpointStatus writeCheckpoint(const std::string &filename, const Checkpoint &checkpoint) {
+    auto temporary = filename + ".tmp";
+    std::ofstream file(temporary, std::ios_base::out | std::ios_base::binary);
+    if (!file.is_open()) return CHECKPOINT_STATUS_ERROR_OPEN_FAILED;
+
+    CheckpointFileHeader header;
+    header.method = checkpoint.method;
+    header.order = checkpoint.order;
+    header.tableau = checkpoint.tableau;
+    header.dimension = checkpoint.y.size();
+    header.historySize = checkpoint.history.size();
+    header.step = checkpoint.step;
+    header.t = checkpoint.t;
+    header.h = checkpoint.h;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(checkpoint.y.data()),
+               (std::streamsize) (checkpoint.y.size() * sizeof(double)));
+    file.write(reinterpret_cast<const char *>(checkpoint.history.data()),
+               (std::streamsize) (checkpoint.history.size() * sizeof(double)));
+    file.close();
+    if (!file) return CHECKPOINT_STATUS_ERROR_IO_FAILED;
+
+    return std::rename(temporary.c_str(), filename.c_str()) == 0 ? CHECKPOINT_STATUS_OK
+                                                                  : CHECKPOINT_STATUS_ERROR_IO_FAILED;
+}
+
+
+/**
+ * Read a checkpoint from a file.
+ * @param filename the file to read.
+ * @param checkpoint the checkpoint to store the result in. It is left unchanged unless reading succeeds.
+ * @return STATUS_OK if the file was read, STATUS_ERROR_OPEN_FAILED if it could not be opened,
+ *         STATUS_ERROR_IO_FAILED if reading fails or its header is truncated, or STATUS_ERROR_INVALID_FORMAT if it
+ *         is not a checkpoint file or holds fewer values than its header says (checked before anything is allocated).
+ */
+CheckpointStatus readCheckpoint(const std::string &filename, Checkpoint &checkpoint) {
+    std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open()) return CHECKPOINT_STATUS_ERROR_OPEN_FAILED;
+
+    CheckpointFileHeader expected;
+    CheckpointFileHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file) return CHECKPOINT_STATUS_ERROR_IO_FAILED;
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+        header.method > CHECKPOINT_METHOD_EMBEDDED_RUNGE_KUTTA) {
+        return CHECKPOINT_STATUS_ERROR_INVALID_FORMAT;
+    }
+
+    // Check the sizes the header claims against the file before allocating for them.
+    auto start = file.tellg();
+    file.seekg(0, std::ios_base::end);
+    auto remaining = (std::uint64_t) (file.tellg() - start);
+    file.seekg(start);
+    if (!file) return CHECKPOINT_STATUS_ERROR_IO_FAILED;
+    if (header.dimension > remaining / sizeof(double) ||
+        header.historySize > (remaining - header.dimension * sizeof(double)) / sizeof(double)) {
+        return CHECKPOINT_STATUS_ERROR_INVALID_FORMAT;
+    }
+
+    // Read into a new checkpoint, so that `checkpoint` is left untouched if reading fails.
+    Checkpoint read;
+    read.method = static_cast<CheckpointMethod>(header.method);
+    read.order = header.order;
+    read.tableau = header.tableau;
+    read.step = header.step;
+    read.t = header.t;
+    read.h = header.h;
+
+    read.y.resize(header.dimension);
+    read.history.resize(header.historySize);
+    file.read(reinterpret_cast<char *>(read.y.data()), (std::streamsize) (header.dimension * sizeof(double)));
+    file.read(reinterpret_cast<char *>(read.history.data()), (std::streamsize) (header.historySize * sizeof(double)));
+    if (!file) return CHECKPOINT_STATUS_ERROR_IO_FAILED;
+
+    checkpoint = std::move(read);
+    return CHECKPOINT_STATUS_OK;
+}
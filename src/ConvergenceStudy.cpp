@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#include "ConvergenceStudy.h"
+
+
+/**
+ * Check the settings of a convergence study: at least 2 time points, between 2 and 31 integrations, a finest
+ * integration whose number of time points fits in an int and a positive tolerance.
+ * @param options the settings of the study.
+ * @return STATUS_OK if they are valid, STATUS_ERROR_INVALID_OPTIONS otherwise.
+ */
+ConvergenceStatus checkConvergenceOptions(const ConvergenceOptions &options) {
+    if (options.n < 2 || options.levels < 2 || options.levels > 31 || !(options.tolerance > 0)) {
+        return CONVERGENCE_STATUS_ERROR_INVALID_OPTIONS;
+    }
+
+    // The finest integration has (n - 1) 2^(levels - 1) + 1 time points.
+    auto steps = (long long) (options.n - 1) << (options.levels - 1);
+    if (steps > std::numeric_limits<int>::max() - 1) return CONVERGENCE_STATUS_ERROR_INVALID_OPTIONS;
+
+    return CONVERGENCE_STATUS_OK;
+}
+
+
+/**
+ * Estimate the order and the global errors of a set of integrations, each with twice as many steps as the previous
+ * one, by Richardson extrapolation, and fill in `result` (see `convergenceStudy`).
+ * @param solutions the solution of each integration at the time points of the coarsest one. They are consumed.
+ * @param methodOrder the order of the method, used when no order can be observed.
+ * @param options the settings of the study.
+ * @param result the result to fill in. Its levels must already hold the number of time points, status and time of
+ *        each integration. Its status is set to STATUS_ERROR_INVALID_OPTIONS if there are fewer than 2 of them, or
+ *        not one solution per level.
+ */
+void analyzeConvergence(std::vector<Trajectory> &solutions, int methodOrder, const ConvergenceOptions &options,
+                        ConvergenceResult &result) {
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto &levels = result.levels;
+    auto count = (int) levels.size();
+    if (count < 2 || solutions.size() != count) {
+        result.status = CONVERGENCE_STATUS_ERROR_INVALID_OPTIONS;
+        return;
+    }
+
+    // Every integration must have run to the end, so that they all hold the same time points.
+    for (auto k = 0; k < count; k++) {
+        if (levels[k].status != 0 || solutions[k].size() != options.n) {
+            result.status = CONVERGENCE_STATUS_ERROR_SOLVER_FAILED;
+            return;
+        }
+    }
+
+    // Differences between consecutive integrations, and the orders they show.
+    for (auto k = 0; k < count; k++) {
+        levels[k].difference = nan;
+        levels[k].order = nan;
+        if (k + 1 < count) {
+            auto values = solutions[k].data();
+            auto finer = solutions[k + 1].data();
+            auto difference = 0.0;
+            for (auto i = 0; i < values.size(); i++) {
+                difference = std::max(difference, std::fabs(values[i] - finer[i]));
+            }
+            levels[k].difference = difference;
+        }
+    }
+    for (auto k = 0; k + 2 < count; k++) {
+        levels[k].order = std::log2(levels[k].difference / levels[k + 1].difference);
+    }
+
+    // The order observed closest to the limit, unless the differences do not shrink there (such as when they are down
+    // to rounding errors).
+    result.order = methodOrder;
+    if (count >= 3) {
+        auto observed = levels[count - 3].order;
+        if (std::isfinite(observed) && observed > 0) result.order = observed;
+    }
+
+    auto factor = std::pow(2.0, result.order);
+    for (auto k = 0; k + 1 < count; k++) {
+        levels[k].error = levels[k].difference * factor / (factor - 1);
+    }
+    levels[count - 1].error = levels[count - 2].difference / (factor - 1);
+
+    // The cheapest integration within the tolerance or, failing that, the number of time points the error model of
+    // the finest one predicts.
+    result.status = CONVERGENCE_STATUS_ERROR_TOLERANCE_NOT_MET;
+    for (auto &level : levels) {
+        if (level.error <= options.tolerance) {
+            result.status = CONVERGENCE_STATUS_OK;
+            result.n = level.n;
+            result.error = level.error;
+            break;
+        }
+    }
+    if (result.status != CONVERGENCE_STATUS_OK) {
+        auto &finest = levels[count - 1];
+        auto steps = (finest.n - 1) * std::pow(finest.error / options.tolerance, 1 / result.order);
+        result.n = (int) std::min(std::ceil(steps) + 1, (double) std::numeric_limits<int>::max());
+        result.error = options.tolerance;
+    }
+
+    result.solution = std::move(solutions[count - 1]);
+    if (options.extrapolate) {
+        auto values = result.solution.data();
+        auto coarser = solutions[count - 2].data();
+        for (auto i = 0; i < values.size(); i++) {
+            values[i] += (values[i] - coarser[i]) / (factor - 1);
+        }
+    }
+}
+
+
+/**
+ * Print one line per integration of a convergence study (number of time points, difference from the next one,
+ * observed order, estimated error and time), followed by the chosen number of time points.
+ * @param stream the stream to write to.
+ * @param result the result of the study.
+ * @param options the settings of the study.
+ */
+void printConvergenceSummary(std::ostream &stream, const ConvergenceResult &result, const ConvergenceOptions &options) {
+    stream << std::right << std::setw(12) << "points" << std::setw(14) << "difference" << std::setw(8) << "order"
+           << std::setw(14) << "error" << std::setw(12) << "time [s]" << std::endl;
+
+    for (auto &level : result.levels) {
+        stream << std::setw(12) << level.n;
+        if (level.status != 0) {
+            stream << "  failed with status " << level.status << std::endl;
+            continue;
+        }
+        // The finest integrations have no difference or order, which are left blank.
+        stream << std::scientific << std::setprecision(3) << std::setw(14);
+        if (std::isnan(level.difference)) stream << "";
+        else stream << level.difference;
+        stream << std::fixed << std::setprecision(2) << std::setw(8);
+        if (std::isnan(level.order)) stream << "";
+        else stream << level.order;
+        stream << std::scientific << std::setprecision(3) << std::setw(14) << level.error << std::fixed
+               << std::setprecision(4) << std::setw(12) << level.seconds << std::defaultfloat << std::endl;
+    }
+
+    if (result.status == CONVERGENCE_STATUS_OK) {
+        stream << result.n << " time points meet the tolerance of " << options.tolerance << " (estimated error "
+               << result.error << ", order " << result.order << ")." << std::endl;
+    }
+    else if (result.status == CONVERGENCE_STATUS_ERROR_TOLERANCE_NOT_MET) {
+        stream << "No integration meets the tolerance of " << options.tolerance << ". About " << result.n
+               << " time points should (order " << result.order << ")." << std::endl;
+    }
+    else if (result.status == CONVERGENCE_STATUS_ERROR_INVALID_OPTIONS) {
+        stream << "Invalid options: the study needs at least 2 time points, 2 to 31 integrations, at most "
+               << std::numeric_limits<int>::max() << " time points in the finest one and a positive tolerance."
+               << std::endl;
+    }
+    else {
+        stream << "An integration failed." << std::endl;
+    }
+}
@@ -0,0 +1,28 @@
+#include <algorithm>
+
+#include "CsvWriter.h"
+
+
+/**
+ * @param stream the stream to write to. It must outlive the writer.
+ * @param capacity the size of the output buffer in bytes.
+ */
+CsvWriter::CsvWriter(std::ostream &stream, std::size_t capacity)
+        : stream(stream), buffer(std::max(capacity, 2 * maxValueLength)) {
+}
+
+/**
+ * Flushes the remaining buffered output to the stream.
+ */
+CsvWriter::~CsvWriter() {
+    flush();
+}
+
+/**
+ * Hands the buffered output to the stream.
+ */
+void CsvWriter::flush() {
+    if (used == 0) return;
+    stream.write(buffer.data(), (std::streamsize) used);
+    used = 0;
+}
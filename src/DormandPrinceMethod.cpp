@@ -0,0 +1,32 @@
+#include "DormandPrinceMethod.h"
+
+
+/**
+ * Uses the Dormand-Prince 5(4) method to solve a system of ODEs of the form:
+ *
+ *      y1' = f1(t, y1, ..., yn), t0 < t < t1
+ *          :
+ *      yn' = fn(t, y1, ..., yn), t0 < t < t1
+ *
+ * From the initial conditions:
+ *
+ *      y1(t0), ..., yn(t0)
+ *
+ * @param f the vector of functions {f1, ..., fn}.
+ * @param trajectory the trajectory to store the accepted steps in. Its previous contents are discarded.
+ * @param y0 the initial condition vector.
+ * @param t0 the initial time.
+ * @param t1 the final time (must be greater than t0).
+ * @param options the tolerances and step size limits.
+ * @return STATUS_OK if method succeeds, STATUS_ERROR_DIMENSION_MISMATCH if the number of functions and initial
+ *         conditions does not match, STATUS_ERROR_STEP_SIZE_TOO_SMALL if the step size underflows, or
+ *         STATUS_ERROR_TOO_MANY_STEPS if `options.maxSteps` is exceeded.
+ */
+DormandPrinceStatus dormandPrinceMethod(const std::vector<funcn> &f, Trajectory &trajectory,
+                                        const std::vector<double> &y0, double t0, double t1,
+                                        const DormandPrinceOptions &options) {
+    // Make sure the size of the func vector and initial conditions match.
+    if (f.size() != y0.size()) return DORMAND_PRINCE_STATUS_ERROR_DIMENSION_MISMATCH;
+
+    return dormandPrinceMethod(FunctionVectorSystem(f), trajectory, y0, t0, t1, options);
+}
@@ -0,0 +1,144 @@
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "EnergyMonitor.h"
+#include "RungeKuttaMethod.h"
+#include "SymplecticMethod.h"
+#include "TrapezoidalMethod.h"
+
+
+enum Method {
+    METHOD_TRAPEZOIDAL,
+    METHOD_RUNGE_KUTTA,
+    METHOD_VELOCITY_VERLET,
+    METHOD_YOSHIDA_4,
+    METHOD_YOSHIDA_6
+};
+
+const char *methodNames[] = {"trapezoidal", "rk4", "verlet", "yoshida4", "yoshida6"};
+
+// Evaluations of the right-hand side (or of the acceleration) per step.
+const int evaluations[] = {2, 4, 1, 3, 7};
+
+
+/**
+ * A conservative system y = (q, v) with q' = v and v' = a(q), written both as a first order system for the
+ * Runge-Kutta methods and as an acceleration for the symplectic ones.
+ */
+template <std::size_t N, typename Acceleration, typename Energy>
+struct ConservativeSystem {
+    std::string name;
+    Acceleration acceleration;
+    Energy energy;
+    std::array<double, N> y0;
+    double t1;
+};
+
+
+/**
+ * Integrate the system over [0, t1] with n time points.
+ * @return the energy drift.
+ */
+template <std::size_t N, typename Acceleration, typename Energy>
+EnergyDrift drift(Method method, const ConservativeSystem<N, Acceleration, Energy> &system, int n) {
+    auto &a = system.acceleration;
+    auto f = [&](double t, const double *y, double *dydt) {
+        for (auto j = 0; j < N / 2; j++) {
+            dydt[j] = y[N / 2 + j];
+        }
+        a(t, y, dydt + N / 2);
+    };
+
+    EnergyMonitor monitor(system.energy);
+    switch (method) {
+        case METHOD_TRAPEZOIDAL:
+            trapezoidalMethod(f, system.y0, 0, system.t1, n, monitor);
+            break;
+        case METHOD_RUNGE_KUTTA:
+            rungeKuttaMethod(f, system.y0, 0, system.t1, n, monitor);
+            break;
+        case METHOD_VELOCITY_VERLET:
+            symplecticMethod<VELOCITY_VERLET_SCHEME>(a, system.y0, 0, system.t1, n, monitor);
+            break;
+        case METHOD_YOSHIDA_4:
+            symplecticMethod<YOSHIDA_4_SCHEME>(a, system.y0, 0, system.t1, n, monitor);
+            break;
+        case METHOD_YOSHIDA_6:
+            symplecticMethod<YOSHIDA_6_SCHEME>(a, system.y0, 0, system.t1, n, monitor);
+            break;
+    }
+    return monitor.drift();
+}
+
+
+/**
+ * For every method, double the number of steps until the energy stays within `tolerance` of its initial value over
+ * the whole run, and report the largest step size that does so.
+ */
+template <std::size_t N, typename Acceleration, typename Energy>
+void report(const ConservativeSystem<N, Acceleration, Energy> &system, double tolerance) {
+    const auto maxSteps = 1 << 24;
+
+    std::cout << system.name << " over t = " << system.t1 << ", max |dE / E0| <= " << tolerance << std::endl;
+    std::cout << std::setw(14) << "method" << std::setw(12) << "steps" << std::setw(14) << "h" << std::setw(14)
+              << "evaluations" << std::setw(14) << "max |dE/E0|" << std::setw(14) << "final dE/E0" << std::setw(14)
+              << "h / h_trap" << std::endl;
+
+    auto trapezoidalStep = 0.0;
+    for (auto method : {METHOD_TRAPEZOIDAL, METHOD_RUNGE_KUTTA, METHOD_VELOCITY_VERLET, METHOD_YOSHIDA_4,
+                        METHOD_YOSHIDA_6}) {
+        auto steps = 16;
+        auto result = drift(method, system, steps + 1);
+        while (!(result.maxRelative <= tolerance) && steps < maxSteps) {
+            steps *= 2;
+            result = drift(method, system, steps + 1);
+        }
+
+        auto h = system.t1 / steps;
+        if (method == METHOD_TRAPEZOIDAL) trapezoidalStep = h;
+
+        std::cout << std::setw(14) << methodNames[method] << std::setw(12) << steps << std::setw(14) << h
+                  << std::setw(14) << (long) steps * evaluations[method] << std::setw(14) << result.maxRelative
+                  << std::setw(14) << result.finalRelative << std::setw(14) << h / trapezoidalStep;
+        if (!(result.maxRelative <= tolerance)) std::cout << "  (not reached)";
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
+int main() {
+    const auto tolerance = 1e-4;
+
+    // The orbit of trapezoidalMethodOrbitDemo, over ten years. Coordinates are: sx, sy, vx, vy.
+    const auto mu = 6.674e-11 * 5.97e24;
+    auto orbitAcceleration = [=](double t, const double *q, double *a) {
+        auto radius = sqrt(q[0] * q[0] + q[1] * q[1]);
+        auto scale = -mu / (radius * radius * radius);
+        a[0] = scale * q[0];
+        a[1] = scale * q[1];
+    };
+    auto orbitEnergy = [=](const double *y) {
+        return 0.5 * (y[2] * y[2] + y[3] * y[3]) - mu / sqrt(y[0] * y[0] + y[1] * y[1]);
+    };
+    report(ConservativeSystem<4, decltype(orbitAcceleration), decltype(orbitEnergy)>{
+            "orbit", orbitAcceleration, orbitEnergy, {0, 3.577e8, 1023, 0}, 10 * 365 * 86400.0}, tolerance);
+
+    // The undamped pendulum of trapezoidalMethodPendulumDemo, released at 1 rad, for about 5000 periods. Coordinates
+    // are: theta, omega.
+    const auto gravity = 9.81;
+    const auto length = 1.0;
+    auto pendulumAcceleration = [=](double t, const double *q, double *a) {
+        a[0] = -(gravity / length) * sin(q[0]);
+    };
+    auto pendulumEnergy = [=](const double *y) {
+        return 0.5 * length * y[1] * y[1] + gravity * (1 - cos(y[0]));
+    };
+    report(ConservativeSystem<2, decltype(pendulumAcceleration), decltype(pendulumEnergy)>{
+            "pendulum", pendulumAcceleration, pendulumEnergy, {1, 0}, 10000.0}, tolerance);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "EnsembleMethod.h"
+#include "RungeKuttaMethod.h"
+#include "TrapezoidalMethod.h"
+
+
+// Predator-prey coefficients, as in PredatorPrey.cpp.
+const auto a = 2.0;
+const auto b = 0.01;
+const auto c = 1.0;
+const auto d = 0.01;
+
+
+/**
+ * Integrate every initial condition one after another, the way PredatorPrey used to.
+ * @return the wall time in seconds.
+ */
+double sequential(EnsembleScheme scheme, int n, const std::vector<std::vector<double>> &y0, double t0, double t1,
+                  std::vector<Trajectory> &trajectories) {
+    auto f = [](double t, const double *y, double *dydt) {
+        dydt[0] = a * y[0] - b * y[0] * y[1];
+        dydt[1] = -c * y[1] + d * y[0] * y[1];
+    };
+
+    StepperWorkspace workspace;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < y0.size(); i++) {
+        if (scheme == ENSEMBLE_SCHEME_TRAPEZOIDAL) {
+            trapezoidalMethod(f, trajectories[i], y0[i], t0, t1, workspace);
+        }
+        else {
+            rungeKuttaMethod(f, trajectories[i], y0[i], t0, t1, workspace);
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+ * Integrate every initial condition in lockstep with `ensembleMethod`.
+ * @return the wall time in seconds.
+ */
+double ensemble(EnsembleScheme scheme, int n, const std::vector<std::vector<double>> &y0, double t0, double t1,
+                std::vector<Trajectory> &trajectories) {
+    auto f = [](double t, const double *y, double *dydt, std::size_t lanes) {
+        for (std::size_t l = 0; l < lanes; l++) {
+            auto x = y[l];
+            auto z = y[lanes + l];
+            dydt[l] = a * x - b * x * z;
+            dydt[lanes + l] = -c * z + d * x * z;
+        }
+    };
+
+    StepperWorkspace workspace;
+    auto start = std::chrono::steady_clock::now();
+    ensembleMethod(scheme, f, trajectories, y0, t0, t1, workspace);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main() {
+    auto n = 10000;
+    auto t0 = 0.0;
+    auto t1 = 10.0;
+
+    std::cout << std::setw(12) << "scheme" << std::setw(10) << "members" << std::setw(16) << "sequential [s]"
+              << std::setw(16) << "ensemble [s]" << std::setw(10) << "speedup" << std::setw(14) << "max |diff|"
+              << std::endl;
+
+    for (auto scheme : {ENSEMBLE_SCHEME_TRAPEZOIDAL, ENSEMBLE_SCHEME_RUNGE_KUTTA}) {
+        for (auto members : {10, 100, 1000}) {
+            // Spread the initial conditions along the same line as the PredatorPrey demo.
+            std::vector<std::vector<double>> y0;
+            for (auto i = 0; i < members; i++) {
+                y0.push_back({100.0 + 900.0 * i / members, 200.0 + 360.0 * i / members});
+            }
+
+            std::vector<Trajectory> expected(members, Trajectory(n, 2));
+            std::vector<Trajectory> actual(members, Trajectory(n, 2));
+
+            auto sequentialTime = sequential(scheme, n, y0, t0, t1, expected);
+            auto ensembleTime = ensemble(scheme, n, y0, t0, t1, actual);
+
+            auto difference = 0.0;
+            for (auto i = 0; i < members; i++) {
+                for (auto j = 0; j < 2; j++) {
+                    difference = std::max(difference, std::fabs(expected[i](n - 1, j) - actual[i](n - 1, j)));
+                }
+            }
+
+            std::cout << std::setw(12) << (scheme == ENSEMBLE_SCHEME_TRAPEZOIDAL ? "trapezoidal" : "rk4")
+                      << std::setw(10) << members << std::setw(16) << sequentialTime << std::setw(16) << ensembleTime
+                      << std::setw(10) << sequentialTime / ensembleTime << std::setw(14) << difference << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <map>
+
+#include "exprtk.hpp"
+
+#include "ExpressionSystem.h"
+
+typedef exprtk::symbol_table<double> symbol_table_t;
+typedef exprtk::expression<double> expression_t;
+typedef exprtk::parser<double> parser_t;
+
+
+struct ExpressionSystem::Impl {
+    // Storage the compiled expressions are bound to. `y` is never resized after compilation, since exprtk holds a
+    // pointer to its data.
+    double t = 0;
+    std::vector<double> y;
+
+    // Storage the fused program writes every component to.
+    std::vector<double> dydt;
+
+    symbol_table_t symbolTable;
+    std::vector<expression_t> expressions;
+    std::string error;
+
+    // The fused program, used to evaluate the whole system if `program` is not empty.
+    expression_t fused;
+    std::string program;
+};
+
+
+namespace {
+
+struct Token {
+    std::string text;
+    // Whether the token was preceded by whitespace, so the expression can be written back as it was.
+    bool spaced = false;
+};
+
+// Identifiers that are operators rather than functions, so a parenthesis after them opens a group, not a call.
+bool isOperatorKeyword(const std::string &name) {
+    static const char *keywords[] = {"and", "nand", "or", "nor", "xor", "xnor", "mand", "mor", "in", "like", "ilike",
+                                     "not"};
+    return std::find(std::begin(keywords), std::end(keywords), name) != std::end(keywords);
+}
+
+// Statements and other constructs whose meaning could change if parts of the expression were hoisted.
+bool isStatementKeyword(const std::string &name) {
+    static const char *keywords[] = {"var", "for", "while", "repeat", "until", "switch", "case", "default", "return",
+                                     "break", "continue", "const"};
+    return std::find(std::begin(keywords), std::end(keywords), name) != std::end(keywords);
+}
+
+bool isIdentifier(const std::string &text) {
+    return std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_';
+}
+
+/**
+ * Split an expression into identifiers, numbers and operators.
+ * @return false if the expression contains a construct that cannot be fused.
+ */
+bool tokenize(const std::string &expression, std::vector<Token> &tokens) {
+    static const char *operators[] = {":=", "+=", "-=", "*=", "/=", "%=", "<=", ">=", "==", "!=", "<>", "&&", "||",
+                                      "<<", ">>", "//", "/*"};
+    auto spaced = false;
+    for (std::size_t i = 0; i < expression.size();) {
+        auto c = static_cast<unsigned char>(expression[i]);
+        if (std::isspace(c)) {
+            spaced = true;
+            i++;
+            continue;
+        }
+
+        auto j = i + 1;
+        if (std::isalpha(c) || c == '_') {
+            while (j < expression.size() && (std::isalnum(static_cast<unsigned char>(expression[j])) ||
+                                             expression[j] == '_')) j++;
+        }
+        else if (std::isdigit(c) || (c == '.' && j < expression.size() && std::isdigit(expression[j]))) {
+            while (j < expression.size() && (std::isdigit(expression[j]) || expression[j] == '.')) j++;
+            if (j < expression.size() && (expression[j] == 'e' || expression[j] == 'E')) {
+                auto k = j + 1;
+                if (k < expression.size() && (expression[k] == '+' || expression[k] == '-')) k++;
+                if (k < expression.size() && std::isdigit(expression[k])) {
+                    j = k;
+                    while (j < expression.size() && std::isdigit(expression[j])) j++;
+                }
+            }
+        }
+        else {
+            for (auto op : operators) {
+                if (expression.compare(i, 2, op) == 0) {
+                    j = i + 2;
+                    break;
+                }
+            }
+        }
+
+        Token token{expression.substr(i, j - i), spaced};
+        if (token.text == ";" || token.text == "{" || token.text == "}" || token.text == "'" || token.text == "#" ||
+            token.text == "~" || token.text == "$" || token.text == "//" || token.text == "/*" ||
+            (token.text.size() == 2 && token.text[1] == '=' && std::string("<>=!").find(token.text[0]) ==
+                                                               std::string::npos) ||
+            (isIdentifier(token.text) && isStatementKeyword(token.text))) {
+            return false;
+        }
+
+        tokens.push_back(std::move(token));
+        spaced = false;
+        i = j;
+    }
+    return true;
+}
+
+// A function call or parenthesized group, tokens [begin, end).
+struct Group {
+    std::size_t begin;
+    std::size_t end;
+    std::string key;
+};
+
+/**
+ * @return whether the token at `i` refers to the state vector `y` as a whole or to a range of it, as in `sum(y)`,
+ *         `y + 1` or `y[0:2]`, rather than to one of its elements.
+ */
+bool isVectorReference(const std::vector<Token> &tokens, std::size_t i) {
+    if (tokens[i].text != "y") return false;
+    if (i + 1 == tokens.size() || tokens[i + 1].text != "[") return true;
+
+    auto depth = 0;
+    for (auto j = i + 1; j < tokens.size(); j++) {
+        if (tokens[j].text == "[") depth++;
+        else if (tokens[j].text == "]" && --depth == 0) return false;
+        else if (tokens[j].text == ":" && depth == 1) return true;
+    }
+    return true;
+}
+
+/**
+ * Find every function call and every parenthesized group of an expression that does more than read a value, so that
+ * `(y[0])` is not worth hoisting but `(y[0] + 1)` and `sqrt(y[0])` are. Groups that refer to `y` as a vector are
+ * skipped, since a group such as `(y + 1)` is itself a vector and cannot be held in a scalar variable.
+ */
+std::vector<Group> findGroups(const std::vector<Token> &tokens) {
+    std::vector<Group> groups;
+    std::vector<std::size_t> open;
+    for (std::size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i].text == "(") {
+            open.push_back(i);
+        }
+        else if (tokens[i].text == ")" && !open.empty()) {
+            auto begin = open.back();
+            open.pop_back();
+
+            auto call = begin > 0 && isIdentifier(tokens[begin - 1].text) && !isOperatorKeyword(tokens[begin - 1].text);
+            auto nontrivial = call;
+            auto vector = false;
+            for (auto j = begin + 1; j < i; j++) {
+                auto &text = tokens[j].text;
+                nontrivial = nontrivial || (!isIdentifier(text) && !std::isdigit(static_cast<unsigned char>(text[0])) &&
+                                            text[0] != '(' && text != ")" && text != "." && text != "[" && text != "]");
+                vector = vector || isVectorReference(tokens, j);
+            }
+            if (!nontrivial || vector) continue;
+
+            Group group{call ? begin - 1 : begin, i + 1, ""};
+            for (auto j = group.begin; j < group.end; j++) {
+                group.key += tokens[j].text;
+                group.key += ' ';
+            }
+            groups.push_back(std::move(group));
+        }
+    }
+    return groups;
+}
+
+std::string join(const std::vector<Token> &tokens, std::size_t begin, std::size_t end) {
+    std::string text;
+    for (auto i = begin; i < end; i++) {
+        if (tokens[i].spaced && i > begin) text += ' ';
+        text += tokens[i].text;
+    }
+    return text;
+}
+
+}
+
+
+/**
+ * Fuse the expressions {f1, ..., fn} into a single exprtk program that assigns every component to the vector `output`.
+ * Function calls and parenthesized subexpressions that occur more than once are hoisted into local variables,
+ * innermost first, so each is computed once per evaluation. Subexpressions that refer to `y` as a vector are never
+ * hoisted.
+ * @param expressions the expression strings, one per component.
+ * @param output the name of the vector to assign the components to.
+ * @return the fused program, or an empty string if an expression cannot be fused.
+ */
+std::string fuseExpressions(const std::vector<std::string> &expressions, const std::string &output) {
+    std::vector<std::vector<Token>> tokens(expressions.size());
+    for (auto i = 0; i < expressions.size(); i++) {
+        if (!tokenize(expressions[i], tokens[i]) || tokens[i].empty()) return "";
+    }
+
+    std::string program;
+    for (auto hoisted = 0;; hoisted++) {
+        // Pick the shortest subexpression that occurs more than once, so any shared subexpression inside it has
+        // already been replaced by its variable.
+        std::map<std::string, int> counts;
+        const Group *shortest = nullptr;
+        std::vector<std::vector<Group>> groups(tokens.size());
+        for (auto i = 0; i < tokens.size(); i++) {
+            groups[i] = findGroups(tokens[i]);
+            for (auto &group : groups[i]) counts[group.key]++;
+        }
+        std::size_t source = 0;
+        for (auto i = 0; i < groups.size(); i++) {
+            for (auto &group : groups[i]) {
+                if (counts[group.key] > 1 && (!shortest || group.end - group.begin < shortest->end - shortest->begin)) {
+                    shortest = &group;
+                    source = i;
+                }
+            }
+        }
+        if (!shortest) break;
+
+        auto name = "cse_" + std::to_string(hoisted);
+        auto key = shortest->key;
+        program += "var " + name + " := " + join(tokens[source], shortest->begin, shortest->end) + ";\n";
+
+        // Replace every occurrence, last first so the earlier positions stay valid. Occurrences cannot overlap, since
+        // a group never contains a copy of itself. The variable keeps its parentheses, so implicit multiplication
+        // such as `2(x + 1)` still parses.
+        for (auto i = 0; i < tokens.size(); i++) {
+            for (auto group = groups[i].rbegin(); group != groups[i].rend(); group++) {
+                if (group->key != key) continue;
+                Token variable{"(" + name + ")", tokens[i][group->begin].spaced};
+                tokens[i].erase(tokens[i].begin() + group->begin + 1, tokens[i].begin() + group->end);
+                tokens[i][group->begin] = std::move(variable);
+            }
+        }
+    }
+
+    for (auto i = 0; i < tokens.size(); i++) {
+        program += output + "[" + std::to_string(i) + "] := (" + join(tokens[i], 0, tokens[i].size()) + ");\n";
+    }
+    return program;
+}
+
+
+ExpressionSystem::ExpressionSystem() : impl(std::make_unique<Impl>()) {}
+
+ExpressionSystem::~ExpressionSystem() = default;
+
+
+/**
+ * Parse and compile the expressions {f1, ..., fn}. Any previously compiled expressions are discarded.
+ * @param expressions the expression strings, one per component.
+ * @return EXPRESSION_STATUS_OK if every expression compiles, EXPRESSION_STATUS_ERROR_PARSE_FAILED otherwise (see
+ *         `error` for the reason).
+ */
+ExpressionStatus ExpressionSystem::compile(const std::vector<std::string> &expressions) {
+    impl->expressions.clear();
+    impl->error.clear();
+    impl->program.clear();
+    impl->fused = expression_t();
+
+    impl->t = 0;
+    impl->y.assign(expressions.size(), 0);
+    impl->dydt.assign(expressions.size(), 0);
+
+    impl->symbolTable = symbol_table_t();
+    impl->symbolTable.add_variable("t", impl->t);
+    impl->symbolTable.add_vector("y", impl->y);
+
+    parser_t parser;
+    impl->expressions.resize(expressions.size());
+    for (auto i = 0; i < expressions.size(); i++) {
+        impl->expressions[i].register_symbol_table(impl->symbolTable);
+        if (!parser.compile(expressions[i], impl->expressions[i])) {
+            impl->error = "f" + std::to_string(i) + ": " + parser.error();
+            impl->expressions.clear();
+            return EXPRESSION_STATUS_ERROR_PARSE_FAILED;
+        }
+    }
+
+    // Every component compiles on its own, so the fused program can only fail on a construct `fuseExpressions` did
+    // not anticipate. It is also only used if it agrees with the components at a few probe points, so a program that
+    // compiles but means something else is caught too. Otherwise the components are simply evaluated one by one.
+    auto program = fuseExpressions(expressions, "dydt__");
+    if (!program.empty() && !expressions.empty()) {
+        symbol_table_t output;
+        output.add_vector("dydt__", impl->dydt);
+        impl->fused.register_symbol_table(impl->symbolTable);
+        impl->fused.register_symbol_table(output);
+        if (parser.compile(program, impl->fused) && fusedMatches()) {
+            impl->program = std::move(program);
+        }
+        else {
+            impl->fused = expression_t();
+        }
+        impl->t = 0;
+        std::fill(impl->y.begin(), impl->y.end(), 0.0);
+    }
+
+    return EXPRESSION_STATUS_OK;
+}
+
+
+/**
+ * Check the fused program against the individual expressions at a few arbitrary points. Hoisting does not change the
+ * arithmetic, so the results must agree up to rounding, and be NaN for the same components.
+ * @return whether they agree at every point.
+ */
+bool ExpressionSystem::fusedMatches() {
+    const double probes[][2] = {{0.7, 0.3}, {-1.3, 0.37}, {2.9, -0.61}};
+    for (auto &probe : probes) {
+        impl->t = probe[0];
+        for (std::size_t i = 0; i < impl->y.size(); i++) {
+            impl->y[i] = probe[0] + probe[1] * (i + 1);
+        }
+
+        impl->fused.value();
+        for (std::size_t i = 0; i < impl->expressions.size(); i++) {
+            auto expected = impl->expressions[i].value();
+            auto actual = impl->dydt[i];
+            if (std::isnan(expected) || std::isnan(actual)) {
+                if (std::isnan(expected) != std::isnan(actual)) return false;
+                continue;
+            }
+            auto scale = std::max({1.0, std::fabs(expected), std::fabs(actual)});
+            if (!(std::fabs(expected - actual) <= 1e-12 * scale)) return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @return a description of the last compilation error, or an empty string if there was none.
+ */
+const std::string &ExpressionSystem::error() const {
+    return impl->error;
+}
+
+
+/**
+ * @return the number of components in the system.
+ */
+std::size_t ExpressionSystem::size() const {
+    return impl->expressions.size();
+}
+
+
+/**
+ * Evaluate a single component of the system.
+ * @param index the index of the component.
+ * @param t the time.
+ * @param y the state vector (must have `size()` entries).
+ * @return the value of component `index` at (t, y).
+ */
+double ExpressionSystem::evaluate(std::size_t index, double t, const std::vector<double> &y) {
+    impl->t = t;
+    std::copy(y.begin(), y.end(), impl->y.begin());
+    return impl->expressions[index].value();
+}
+
+
+/**
+ * Evaluate the whole system, copying the state into the bound storage only once. If the expressions were fused, every
+ * component is computed by a single evaluation of the fused program.
+ * @param t the time.
+ * @param y the state (must have `size()` entries).
+ * @param dydt the array to store the value of every component in.
+ */
+void ExpressionSystem::operator()(double t, const double *y, double *dydt) {
+    impl->t = t;
+    std::copy(y, y + impl->y.size(), impl->y.begin());
+    if (!impl->program.empty()) {
+        impl->fused.value();
+        std::copy(impl->dydt.begin(), impl->dydt.end(), dydt);
+        return;
+    }
+    for (auto i = 0; i < impl->expressions.size(); i++) {
+        dydt[i] = impl->expressions[i].value();
+    }
+}
+
+
+/**
+ * @return the fused program used by `operator()`, or an empty string if the components are evaluated one by one
+ *         because the expressions could not be fused.
+ */
+const std::string &ExpressionSystem::program() const {
+    return impl->program;
+}
+
+
+/**
+ * @return the vector of functions {f1, ..., fn}, suitable for `trapezoidalMethod` and `rungeKuttaMethod`.
+ */
+std::vector<funcn> ExpressionSystem::functions() {
+    std::vector<funcn> f(size());
+    for (auto i = 0; i < f.size(); i++) {
+        f[i] = [this, i](double t, const std::vector<double> &y) { return evaluate(i, t, y); };
+    }
+    return f;
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <utility>
+
+#include "IterationMatrix.h"
+
+
+/**
+ * Size the storage for a system of dimension `m`.
+ * @return STATUS_OK.
+ */
+LinearAlgebraStatus DenseIterationMatrix::resize(std::size_t m) {
+    this->m = m;
+    lu.resize(m * m);
+    pivots.resize(m);
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * @return the number of entries of the Jacobian array, m * m.
+ */
+std::size_t DenseIterationMatrix::jacobianSize() const {
+    return m * m;
+}
+
+
+/**
+ * Form I - h J and factor it.
+ * @param h the step size.
+ * @param jacobian the Jacobian.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if the matrix is singular.
+ */
+LinearAlgebraStatus DenseIterationMatrix::factor(double h, const double *jacobian) {
+    for (std::size_t j = 0; j < m * m; j++) {
+        lu[j] = -h * jacobian[j];
+    }
+    for (std::size_t j = 0; j < m; j++) {
+        lu[j * m + j] += 1;
+    }
+    return luFactor(lu.data(), m, pivots.data());
+}
+
+
+/**
+ * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+ */
+void DenseIterationMatrix::solve(double *b) const {
+    luSolve(lu.data(), m, pivots.data(), b);
+}
+
+
+/**
+ * @param lower the number of subdiagonals of the Jacobian.
+ * @param upper the number of superdiagonals of the Jacobian.
+ */
+BandedIterationMatrix::BandedIterationMatrix(std::size_t lower, std::size_t upper) : lower(lower), upper(upper) {}
+
+
+/**
+ * Size the storage for a system of dimension `m`.
+ * @return STATUS_OK.
+ */
+LinearAlgebraStatus BandedIterationMatrix::resize(std::size_t m) {
+    this->m = m;
+    lu.assign(m * (2 * lower + upper + 1), 0.0);
+    pivots.resize(m);
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * @return the number of entries of the Jacobian array, m * (lower + upper + 1).
+ */
+std::size_t BandedIterationMatrix::jacobianSize() const {
+    return m * (lower + upper + 1);
+}
+
+
+/**
+ * Form I - h J and factor it.
+ * @param h the step size.
+ * @param jacobian the Jacobian.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if the matrix is singular.
+ */
+LinearAlgebraStatus BandedIterationMatrix::factor(double h, const double *jacobian) {
+    // From rows of the band to the columns `bandedLuFactor` works on.
+    auto width = lower + upper + 1;
+    auto stride = 2 * lower + upper + 1;
+    for (std::size_t i = 0; i < m; i++) {
+        auto first = i > lower ? i - lower : 0;
+        auto last = std::min(m - 1, i + upper);
+        for (auto j = first; j <= last; j++) {
+            lu[j * stride + lower + upper + i - j] = -h * jacobian[i * width + lower + j - i];
+        }
+        lu[i * stride + lower + upper] += 1;
+    }
+    return bandedLuFactor(lu.data(), m, lower, upper, pivots.data());
+}
+
+
+/**
+ * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+ */
+void BandedIterationMatrix::solve(double *b) const {
+    bandedLuSolve(lu.data(), m, lower, upper, pivots.data(), b);
+}
+
+
+/**
+ * @param pattern the pattern of the Jacobian, checked by `sparseLuAnalyze`. If it is invalid, `status` says so and
+ *        `resize` fails.
+ */
+SparseIterationMatrix::SparseIterationMatrix(SparsePattern pattern) : pattern(std::move(pattern)) {
+    analysis = sparseLuAnalyze(this->pattern, symbolic);
+}
+
+
+/**
+ * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise.
+ */
+LinearAlgebraStatus SparseIterationMatrix::status() const {
+    return analysis;
+}
+
+
+/**
+ * Size the storage for a system of dimension `m`.
+ * @return STATUS_OK, or STATUS_ERROR_INVALID_PATTERN if the pattern is invalid or not of dimension `m`.
+ */
+LinearAlgebraStatus SparseIterationMatrix::resize(std::size_t m) {
+    if (analysis != LINEAR_ALGEBRA_STATUS_OK || m != pattern.m) return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+    lu.resize(symbolic.factors.nonzeros());
+    work.resize(m);
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * @return the number of entries of the Jacobian array, that of the pattern.
+ */
+std::size_t SparseIterationMatrix::jacobianSize() const {
+    return pattern.nonzeros();
+}
+
+
+/**
+ * Form I - h J and factor it.
+ * @param h the step size.
+ * @param jacobian the Jacobian.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus SparseIterationMatrix::factor(double h, const double *jacobian) {
+    std::fill(lu.begin(), lu.end(), 0.0);
+    for (std::size_t p = 0; p < pattern.nonzeros(); p++) {
+        lu[symbolic.positions[p]] -= h * jacobian[p];
+    }
+    for (std::size_t i = 0; i < pattern.m; i++) {
+        lu[symbolic.diagonal[i]] += 1;
+    }
+    return sparseLuFactor(symbolic, lu.data(), work.data());
+}
+
+
+/**
+ * Solve (I - h J) x = b with the last factorization, overwriting `b` with x.
+ */
+void SparseIterationMatrix::solve(double *b) const {
+    sparseLuSolve(symbolic, lu.data(), b);
+}
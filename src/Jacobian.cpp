@@ -0,0 +1,88 @@
+#include <vector>
+
+#include "Jacobian.h"
+
+
+/**
+ * Groups the columns of a Jacobian with the given sparsity pattern so that no two columns in a group have a nonzero
+ * in the same row. The columns of a group can be approximated together with a single evaluation of the system.
+ * @param pattern the m x m row-major sparsity pattern, true where fi depends on yj.
+ * @param m the dimension of the system.
+ * @param colors array of `m` entries to store the group of each column in.
+ * @return the number of groups.
+ */
+std::size_t colorJacobianColumns(const std::vector<bool> &pattern, std::size_t m, std::size_t *colors) {
+    // Greedy coloring: each column joins the first group none of whose columns share a row with it. `used[i * m + c]`
+    // records that row i already has a nonzero in a column of group c.
+    std::vector<bool> used(m * m, false);
+    std::size_t groups = 0;
+
+    for (std::size_t j = 0; j < m; j++) {
+        std::size_t color = 0;
+        for (; color < groups; color++) {
+            auto conflict = false;
+            for (std::size_t i = 0; i < m && !conflict; i++) {
+                conflict = pattern[i * m + j] && used[i * m + color];
+            }
+            if (!conflict) break;
+        }
+        if (color == groups) groups++;
+
+        colors[j] = color;
+        for (std::size_t i = 0; i < m; i++) {
+            if (pattern[i * m + j]) used[i * m + color] = true;
+        }
+    }
+
+    return groups;
+}
+
+
+/**
+ * Groups the columns of a Jacobian with the given sparse pattern so that no two columns in a group have a nonzero in
+ * the same row, in time proportional to the sum over the rows of their squared number of entries.
+ * @param pattern the sparsity pattern, valid according to `checkSparsePattern`, with an entry where fi depends on yj.
+ * @param colors array of `pattern.m` entries to store the group of each column in.
+ * @return the number of groups.
+ */
+std::size_t colorJacobianColumns(const SparsePattern &pattern, std::size_t *colors) {
+    auto m = pattern.m;
+
+    // The rows of each column.
+    std::vector<std::size_t> columnStart(m + 1, 0);
+    for (auto j : pattern.columns) {
+        columnStart[j + 1]++;
+    }
+    for (std::size_t j = 0; j < m; j++) {
+        columnStart[j + 1] += columnStart[j];
+    }
+    std::vector<std::size_t> rows(pattern.nonzeros());
+    std::vector<std::size_t> next(columnStart.begin(), columnStart.end() - 1);
+    for (std::size_t i = 0; i < m; i++) {
+        for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1]; p++) {
+            rows[next[pattern.columns[p]]++] = i;
+        }
+    }
+
+    // Greedy coloring: each column joins the first group that no earlier column sharing a row with it is in.
+    // `taken[c] == j + 1` when group c is ruled out for column j.
+    std::vector<std::size_t> taken(m, 0);
+    std::size_t groups = 0;
+    for (std::size_t j = 0; j < m; j++) {
+        for (auto q = columnStart[j]; q < columnStart[j + 1]; q++) {
+            auto i = rows[q];
+            for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1] && pattern.columns[p] < j; p++) {
+                taken[colors[pattern.columns[p]]] = j + 1;
+            }
+        }
+
+        std::size_t color = 0;
+        while (color < groups && taken[color] == j + 1) {
+            color++;
+        }
+        if (color == groups) groups++;
+        colors[j] = color;
+    }
+
+    return groups;
+}
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "LinearAlgebra.h"
+
+
+/**
+ * Computes the LU factorization of a dense square matrix in place, using partial pivoting:
+ *
+ *      P A = L U
+ *
+ * @param a the m x m matrix in row-major order. It is overwritten by U (on and above the diagonal) and the
+ *        multipliers of L (below the diagonal, whose diagonal is implicitly 1).
+ * @param m the number of rows and columns.
+ * @param pivots array of `m` entries to store the row permutation in.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus luFactor(double *a, std::size_t m, std::size_t *pivots) {
+    for (std::size_t k = 0; k < m; k++) {
+        // Pick the largest entry in the column as the pivot.
+        auto pivot = k;
+        for (auto i = k + 1; i < m; i++) {
+            if (fabs(a[i * m + k]) > fabs(a[pivot * m + k])) pivot = i;
+        }
+        pivots[k] = pivot;
+        if (a[pivot * m + k] == 0) return LINEAR_ALGEBRA_STATUS_ERROR_SINGULAR_MATRIX;
+
+        if (pivot != k) {
+            for (std::size_t j = 0; j < m; j++) {
+                std::swap(a[k * m + j], a[pivot * m + j]);
+            }
+        }
+
+        // Eliminate below the pivot.
+        for (auto i = k + 1; i < m; i++) {
+            auto multiplier = a[i * m + k] / a[k * m + k];
+            a[i * m + k] = multiplier;
+            for (auto j = k + 1; j < m; j++) {
+                a[i * m + j] -= multiplier * a[k * m + j];
+            }
+        }
+    }
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * Solves A x = b given the factorization computed by `luFactor`.
+ * @param lu the factored matrix.
+ * @param m the number of rows and columns.
+ * @param pivots the row permutation.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void luSolve(const double *lu, std::size_t m, const std::size_t *pivots, double *b) {
+    // Apply the permutation and forward substitute with L.
+    for (std::size_t i = 0; i < m; i++) {
+        std::swap(b[i], b[pivots[i]]);
+        for (std::size_t j = 0; j < i; j++) {
+            b[i] -= lu[i * m + j] * b[j];
+        }
+    }
+
+    // Back substitute with U.
+    for (auto i = m; i-- > 0;) {
+        for (auto j = i + 1; j < m; j++) {
+            b[i] -= lu[i * m + j] * b[j];
+        }
+        b[i] /= lu[i * m + i];
+    }
+}
+
+
+/**
+ * Computes the LU factorization of a banded square matrix in place, using partial pivoting. Only the band is stored
+ * and touched, so the work is O(m lower (lower + upper)) and the storage O(m (2 lower + upper)).
+ *
+ * The matrix is stored by columns with `2 lower + upper + 1` entries each, entry (i, j) at
+ *
+ *      ab[j * (2 lower + upper + 1) + lower + upper + i - j]
+ *
+ * for j - upper <= i <= j + lower. The first `lower` entries of each column are extra room for the fill-in from row
+ * interchanges and need not be initialized.
+ *
+ * @param ab the banded matrix, overwritten by U (whose upper bandwidth grows to lower + upper) and the multipliers
+ *        of L.
+ * @param m the number of rows and columns.
+ * @param lower the number of subdiagonals.
+ * @param upper the number of superdiagonals.
+ * @param pivots array of `m` entries to store the row interchanges in.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus bandedLuFactor(double *ab, std::size_t m, std::size_t lower, std::size_t upper,
+                                   std::size_t *pivots) {
+    auto stride = 2 * lower + upper + 1;
+    auto at = [&](std::size_t i, std::size_t j) -> double & { return ab[j * stride + lower + upper + i - j]; };
+
+    // The fill-in rows start out empty.
+    for (std::size_t j = 0; j < m; j++) {
+        std::fill(ab + j * stride, ab + j * stride + lower, 0.0);
+    }
+
+    for (std::size_t k = 0; k < m; k++) {
+        auto last = std::min(m - 1, k + lower);
+        auto right = std::min(m - 1, k + lower + upper);
+
+        // Pick the largest entry in the column as the pivot.
+        auto pivot = k;
+        for (auto i = k + 1; i <= last; i++) {
+            if (fabs(at(i, k)) > fabs(at(pivot, k))) pivot = i;
+        }
+        pivots[k] = pivot;
+        if (at(pivot, k) == 0) return LINEAR_ALGEBRA_STATUS_ERROR_SINGULAR_MATRIX;
+
+        // The pivot row has no entries right of column k + lower + upper.
+        if (pivot != k) {
+            for (auto j = k; j <= right; j++) {
+                std::swap(at(k, j), at(pivot, j));
+            }
+        }
+
+        // Eliminate below the pivot, column by column so the inner loop is contiguous.
+        for (auto i = k + 1; i <= last; i++) {
+            at(i, k) /= at(k, k);
+        }
+        for (auto j = k + 1; j <= right; j++) {
+            auto pivotRow = at(k, j);
+            if (pivotRow == 0) continue;
+            for (auto i = k + 1; i <= last; i++) {
+                at(i, j) -= at(i, k) * pivotRow;
+            }
+        }
+    }
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * Solves A x = b given the factorization computed by `bandedLuFactor`.
+ * @param lu the factored matrix.
+ * @param m the number of rows and columns.
+ * @param lower the number of subdiagonals.
+ * @param upper the number of superdiagonals.
+ * @param pivots the row interchanges.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void bandedLuSolve(const double *lu, std::size_t m, std::size_t lower, std::size_t upper, const std::size_t *pivots,
+                   double *b) {
+    auto stride = 2 * lower + upper + 1;
+    auto at = [&](std::size_t i, std::size_t j) { return lu[j * stride + lower + upper + i - j]; };
+
+    // Apply the interchanges and the multipliers in the order of the elimination.
+    for (std::size_t k = 0; k < m; k++) {
+        std::swap(b[k], b[pivots[k]]);
+        auto last = std::min(m - 1, k + lower);
+        for (auto i = k + 1; i <= last; i++) {
+            b[i] -= at(i, k) * b[k];
+        }
+    }
+
+    // Back substitute with U.
+    for (auto i = m; i-- > 0;) {
+        auto right = std::min(m - 1, i + lower + upper);
+        for (auto j = i + 1; j <= right; j++) {
+            b[i] -= at(i, j) * b[j];
+        }
+        b[i] /= at(i, i);
+    }
+}
+
+
+/**
+ * Checks that a sparse pattern is well formed: `m + 1` row starts, from 0 to the number of entries and nondecreasing,
+ * and the columns of each row strictly increasing and less than `m`.
+ * @param pattern the pattern to check.
+ * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise.
+ */
+LinearAlgebraStatus checkSparsePattern(const SparsePattern &pattern) {
+    auto m = pattern.m;
+    if (pattern.rowStart.size() != m + 1 || pattern.rowStart[0] != 0 || pattern.rowStart[m] != pattern.nonzeros()) {
+        return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+    }
+    for (std::size_t i = 0; i < m; i++) {
+        if (pattern.rowStart[i] > pattern.rowStart[i + 1]) return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+    }
+    for (std::size_t i = 0; i < m; i++) {
+        for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1]; p++) {
+            if (pattern.columns[p] >= m) return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+            if (p > pattern.rowStart[i] && pattern.columns[p] <= pattern.columns[p - 1]) {
+                return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+            }
+        }
+    }
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * Computes the pattern of the LU factors of a sparse matrix with the given pattern, factored without pivoting in the
+ * given order, and where each of its entries goes in them. The diagonal is always part of the factors, whether or not
+ * it is in the pattern.
+ *
+ * The fill-in depends on the ordering: for a matrix whose entries all lie within a band, the factors stay within the
+ * band, so number the unknowns to keep the bandwidth small.
+ *
+ * @param pattern the pattern of the matrix, checked by `checkSparsePattern`.
+ * @param symbolic the analysis to fill in.
+ * @return STATUS_OK if the pattern is valid, STATUS_ERROR_INVALID_PATTERN otherwise, leaving `symbolic` empty.
+ */
+LinearAlgebraStatus sparseLuAnalyze(const SparsePattern &pattern, SparseLuSymbolic &symbolic) {
+    auto m = pattern.m;
+    symbolic = SparseLuSymbolic();
+    if (checkSparsePattern(pattern) != LINEAR_ALGEBRA_STATUS_OK) return LINEAR_ALGEBRA_STATUS_ERROR_INVALID_PATTERN;
+
+    auto &factors = symbolic.factors;
+    factors.m = m;
+    factors.rowStart.assign(1, 0);
+    factors.columns.clear();
+    symbolic.diagonal.resize(m);
+    symbolic.positions.resize(pattern.nonzeros());
+
+    // `mark[j] == i + 1` when column j is already in row i. Row i of the factors holds the columns of row i of the
+    // matrix and, for every k < i in it, the columns right of the diagonal in row k of U. Those left of the diagonal
+    // are found in increasing order through a heap, since each may bring in further ones.
+    std::vector<std::size_t> mark(m, 0);
+    std::vector<std::size_t> position(m);
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> left;
+    std::vector<std::size_t> right;
+
+    for (std::size_t i = 0; i < m; i++) {
+        auto add = [&](std::size_t j) {
+            if (mark[j] == i + 1) return;
+            mark[j] = i + 1;
+            if (j < i) left.push(j);
+            else right.push_back(j);
+        };
+
+        right.clear();
+        add(i);
+        for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1]; p++) {
+            add(pattern.columns[p]);
+        }
+        while (!left.empty()) {
+            auto k = left.top();
+            left.pop();
+            factors.columns.push_back(k);
+            for (auto p = symbolic.diagonal[k] + 1; p < factors.rowStart[k + 1]; p++) {
+                add(factors.columns[p]);
+            }
+        }
+
+        std::sort(right.begin(), right.end());
+        symbolic.diagonal[i] = factors.columns.size();
+        factors.columns.insert(factors.columns.end(), right.begin(), right.end());
+        factors.rowStart.push_back(factors.columns.size());
+
+        for (auto p = factors.rowStart[i]; p < factors.rowStart[i + 1]; p++) {
+            position[factors.columns[p]] = p;
+        }
+        for (auto p = pattern.rowStart[i]; p < pattern.rowStart[i + 1]; p++) {
+            symbolic.positions[p] = position[pattern.columns[p]];
+        }
+    }
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * Computes the LU factorization of a sparse matrix in place, without pivoting:
+ *
+ *      A = L U
+ *
+ * The pivots are the diagonal entries in the analyzed order, which is stable for diagonally dominant matrices such as
+ * the iteration matrix I - h J of small enough steps, but may fail or lose accuracy otherwise.
+ *
+ * @param symbolic the analysis of the matrix's pattern.
+ * @param lu the matrix, with `symbolic.factors.nonzeros()` entries in the order of `symbolic.factors` and zeros in the
+ *        fill-in. It is overwritten by U and the multipliers of L (whose diagonal is implicitly 1).
+ * @param work array of `symbolic.factors.m` entries of scratch storage.
+ * @return STATUS_OK if the factorization succeeds, STATUS_ERROR_SINGULAR_MATRIX if a zero pivot is found.
+ */
+LinearAlgebraStatus sparseLuFactor(const SparseLuSymbolic &symbolic, double *lu, std::size_t *work) {
+    auto &factors = symbolic.factors;
+
+    for (std::size_t i = 0; i < factors.m; i++) {
+        auto begin = factors.rowStart[i];
+        auto end = factors.rowStart[i + 1];
+        auto diagonal = symbolic.diagonal[i];
+
+        // Where each column of row i is, so rows of U can be subtracted from it. The analysis guarantees they fit.
+        for (auto p = begin; p < end; p++) {
+            work[factors.columns[p]] = p;
+        }
+
+        // Eliminate the entries left of the diagonal in increasing column order, as Gaussian elimination would.
+        for (auto p = begin; p < diagonal; p++) {
+            auto k = factors.columns[p];
+            auto multiplier = lu[p] / lu[symbolic.diagonal[k]];
+            lu[p] = multiplier;
+            for (auto q = symbolic.diagonal[k] + 1; q < factors.rowStart[k + 1]; q++) {
+                lu[work[factors.columns[q]]] -= multiplier * lu[q];
+            }
+        }
+
+        if (lu[diagonal] == 0) return LINEAR_ALGEBRA_STATUS_ERROR_SINGULAR_MATRIX;
+    }
+    return LINEAR_ALGEBRA_STATUS_OK;
+}
+
+
+/**
+ * Solves A x = b given the factorization computed by `sparseLuFactor`.
+ * @param symbolic the analysis of the matrix's pattern.
+ * @param lu the factored matrix.
+ * @param b the right-hand side, overwritten with the solution x.
+ */
+void sparseLuSolve(const SparseLuSymbolic &symbolic, const double *lu, double *b) {
+    auto &factors = symbolic.factors;
+
+    // Forward substitute with L.
+    for (std::size_t i = 0; i < factors.m; i++) {
+        for (auto p = factors.rowStart[i]; p < symbolic.diagonal[i]; p++) {
+            b[i] -= lu[p] * b[factors.columns[p]];
+        }
+    }
+
+    // Back substitute with U.
+    for (auto i = factors.m; i-- > 0;) {
+        for (auto p = symbolic.diagonal[i] + 1; p < factors.rowStart[i + 1]; p++) {
+            b[i] -= lu[p] * b[factors.columns[p]];
+        }
+        b[i] /= lu[symbolic.diagonal[i]];
+    }
+}
@@ -1,31 +1,38 @@
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <string>
 #include <vector>
 
-#include "exprtk.hpp"
-
 #include "BackwardEulerMethod.h"
+#include "BatchJob.h"
+#include "ConvergenceStudy.h"
+#include "Dual.h"
+#include "ExpressionSystem.h"
+#include "Jacobian.h"
+#include "Parareal.h"
 #include "RungeKuttaMethod.h"
+#include "TrajectoryFile.h"
 #include "TrapezoidalMethod.h"
 #include "Util.h"
 
 
 void backwardEulerMethodDemo(int index, int n, double y0, double t0, double t1, const std::string &filename) {
+    // The functions are written for a generic `y` so that their derivatives can be computed automatically.
+    auto f1 = [](double t, auto y) { return -10 * y; };
+    auto f2 = [](double t, auto y) { return (1 + (8 - 9 * y) * y) * y; };
+    auto f3 = [](double t, auto y) { return -y * y; };
+    auto f4 = [](double t, auto y) { return -y / (1 + y * y); };
+
     // Vector of functions.
-    std::vector<func1> functions({
-        [](double t, double y) { return -10 * y; },
-        [](double t, double y) { return (1 + (8 - 9 * y) * y) * y; },
-        [](double t, double y) { return -y * y; },
-        [](double t, double y) { return -y / (1 + y * y); }
-    });
+    std::vector<func1> functions({f1, f2, f3, f4});
 
     // Vector of derivatives. These are the partial derivatives of the above functions with respect to y.
-    std::vector<func1> derivatives({
-        [](double t, double y) { return -10; },
-        [](double t, double y) { return 1 + (16 - 27 * y) * y; },
-        [](double t, double y) { return -2 * y; },
-        [](double t, double y) { return (y * y - 1) / ((1 + y * y) * (1 + y * y)); }
-    });
+    std::vector<func1> derivatives({derivative(f1), derivative(f2), derivative(f3), derivative(f4)});
 
     // Choose the function and corresponding derivative.
     auto f = functions[index];
@@ -40,17 +47,17 @@ void backwardEulerMethodDemo(int index, int n, double y0, double t0, double t1,
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
+    Trajectory trajectory(n, 1);
+    for (auto i = 0; i < n; i++) {
+        trajectory.time(i) = t[i];
+        trajectory(i, 0) = y[i];
     }
 
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
@@ -58,36 +65,29 @@ void backwardEulerMethodDemo(int index, int n, double y0, double t0, double t1,
 
 void trapezoidalMethodPendulumDemo(double gravity, double length, double drag, int n, double theta0, double omega0,
                                    double t0, double t1, const std::string &filename) {
-    // Vector of functions. The first entry is f1, second is f2, etc.
-    std::vector<funcn> f({
-        [=](double t, const std::vector<double> &y) { return y[1]; },
-        [=](double t, const std::vector<double> &y) { return -(gravity / length) * sin(y[0]) - drag * y[1]; }
-    });
+    // Coordinates are: theta, omega.
+    auto f = [=](double t, const double *y, double *dydt) {
+        dydt[0] = y[1];
+        dydt[1] = -(gravity / length) * sin(y[0]) - drag * y[1];
+    };
 
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // Trajectory to store result.
+    Trajectory trajectory(n, 2);
 
-    // Initial conditions.
-    std::vector<double> y0({theta0, omega0});
+    // Initial conditions. The dimension is fixed, so the solver is specialized for it.
+    std::array<double, 2> y0({theta0, omega0});
 
-    auto result = trapezoidalMethod(f, t, y, y0, t0, t1);
+    auto result = trapezoidalMethod(f, trajectory, y0, t0, t1);
     if (result != TRAPEZOIDAL_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
-    }
-
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
@@ -103,45 +103,33 @@ void trapezoidalMethodOrbitDemo(int n, double days, const std::string &filename)
     const auto dayLength = 86400;
 
     // Coordinates are: sx, sy, vx, vy.
-    std::vector<funcn> f({
-        [=](double t, const std::vector<double> &y) { return y[2]; },
-        [=](double t, const std::vector<double> &y) { return y[3]; },
-        [=](double t, const std::vector<double> &y) {
-            auto radius = sqrt(pow(y[0], 2) + pow(y[1], 2));
-            auto acceleration = -gravitationalConstant * earthMass / pow(radius, 2);
-            return acceleration * y[0] / radius;    // Component in x direction.
-        },
-        [=](double t, const std::vector<double> &y) {
-            auto radius = sqrt(pow(y[0], 2) + pow(y[1], 2));
-            auto acceleration = -gravitationalConstant * earthMass / pow(radius, 2);
-            return acceleration * y[1] / radius;    // Component in y direction.
-        }
-    });
-
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
-
-    // Initial conditions.
-    std::vector<double> y0({sx0, sy0, vx0, vy0});
-
-    auto result = trapezoidalMethod(f, t, y, y0, 0, days * dayLength);
+    // The radius and acceleration are shared by both velocity components, so they are only computed once.
+    auto f = [=](double t, const double *y, double *dydt) {
+        auto radius = sqrt(pow(y[0], 2) + pow(y[1], 2));
+        auto acceleration = -gravitationalConstant * earthMass / pow(radius, 2);
+        dydt[0] = y[2];
+        dydt[1] = y[3];
+        dydt[2] = acceleration * y[0] / radius;    // Component in x direction.
+        dydt[3] = acceleration * y[1] / radius;    // Component in y direction.
+    };
+
+    // Trajectory to store result.
+    Trajectory trajectory(n, 4);
+
+    // Initial conditions. The dimension is fixed, so the solver is specialized for it.
+    std::array<double, 4> y0({sx0, sy0, vx0, vy0});
+
+    auto result = trapezoidalMethod(f, trajectory, y0, 0, days * dayLength);
     if (result != TRAPEZOIDAL_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
-    }
-
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
@@ -157,43 +145,36 @@ void trapezoidalMethodSIRDemo(int n, double t0, double t1, double s0, double i0,
     r0 /= total;
 
     // Coordinates are: s, i, r.
-    std::vector<funcn> f({
-        [=](double t, const std::vector<double> &y) { return -b * y[0] * y[1]; },
-        [=](double t, const std::vector<double> &y) { return b * y[0] * y[1] - k * y[1]; },
-        [=](double t, const std::vector<double> &y) { return k * y[1]; }
-    });
+    auto f = [=](double t, const double *y, double *dydt) {
+        auto infections = b * y[0] * y[1];
+        auto recoveries = k * y[1];
+        dydt[0] = -infections;
+        dydt[1] = infections - recoveries;
+        dydt[2] = recoveries;
+    };
 
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // Trajectory to store result.
+    Trajectory trajectory(n, 3);
 
-    // Initial conditions.
-    std::vector<double> y0({s0, i0, r0});
+    // Initial conditions. The dimension is fixed, so the solver is specialized for it.
+    std::array<double, 3> y0({s0, i0, r0});
 
-    auto result = trapezoidalMethod(f, t, y, y0, t0, t1);
+    auto result = trapezoidalMethod(f, trajectory, y0, t0, t1);
     if (result != TRAPEZOIDAL_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
     // Undo normalization.
-    for (auto &entry : y) {
-        for (double &value : entry) {
-            value *= total;
-        }
-    }
-
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
+    for (double &value : trajectory.data()) {
+        value *= total;
     }
 
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
@@ -205,93 +186,211 @@ void trapezoidalMethod1DDemo(int n, double y0s, double t0, double t1, const std:
         [](double t, const std::vector<double> &y) { return -10 * y[0]; }
     });
 
-    // The time vector is unchanged. The vector of y files will be indexed like an n x 1 column vector, `y[n][0]`.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // The trajectory stores n states with a single component each, indexed like an n x 1 matrix, `trajectory(i, 0)`.
+    Trajectory trajectory(n, 1);
 
     // We have to convert the initial condition from scalar to vector form.
     std::vector<double> y0({y0s});
 
     // The rest of the code is the same.
-    auto result = trapezoidalMethod(f, t, y, y0, t0, t1);
+    auto result = trapezoidalMethod(f, trajectory, y0, t0, t1);
     if (result != TRAPEZOIDAL_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
-    }
-
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
 
 
-void trapezoidalMethodSystemDemo(const std::vector<funcn> &f, const std::vector<double> &y0, int n, double t0,
+void trapezoidalMethodSystemDemo(const funcsys &f, const std::vector<double> &y0, int n, double t0,
                                  double t1, const std::string &filename) {
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // Trajectory to store result.
+    Trajectory trajectory(n, y0.size());
 
-    auto result = trapezoidalMethod(f, t, y, y0, t0, t1);
+    auto result = trapezoidalMethod(f, trajectory, y0, t0, t1);
     if (result != TRAPEZOIDAL_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
-    }
-
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
 
 
-void rungeKuttaMethodSystemDemo(const std::vector<funcn> &f, const std::vector<double> &y0, int n, double t0,
+void rungeKuttaMethodSystemDemo(const funcsys &f, const std::vector<double> &y0, int n, double t0,
                                 double t1, const std::string &filename) {
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // Trajectory to store result.
+    Trajectory trajectory(n, y0.size());
 
-    auto result = rungeKuttaMethod(f, t, y, y0, t0, t1);
+    auto result = rungeKuttaMethod(f, trajectory, y0, t0, t1);
     if (result != RUNGE_KUTTA_STATUS_OK) {
         std::cerr << "Runge-Kutta method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
+    // Write data to file.
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
         return;
     }
 
+    std::cout << "Done." << std::endl;
+}
+
+
+void convergenceStudyPendulumDemo(int method, double theta0, int n, int levels, double t1, double tolerance,
+                                  bool extrapolate, const std::string &filename) {
+    const auto gravity = 9.81;
+    const auto length = 1.0;
+
+    // Coordinates are: theta, omega. Written for a generic `y` so the backward Euler method gets an exact Jacobian.
+    auto f = [=](double t, const auto *y, auto *dydt) {
+        dydt[0] = y[1];
+        dydt[1] = -(gravity / length) * sin(y[0]);
+    };
+    std::vector<double> y0({theta0, 0});
+
+    ConvergenceOptions options;
+    options.n = n;
+    options.levels = levels;
+    options.tolerance = tolerance;
+    options.extrapolate = extrapolate;
+    if (checkConvergenceOptions(options) != CONVERGENCE_STATUS_OK) {
+        std::cerr << "Invalid number of time points, integrations or tolerance." << std::endl;
+        return;
+    }
+
+    // One integration per thread.
+    ThreadPool pool(levels);
+    ConvergenceResult result;
+    if (method == 1) {
+        result = backwardEulerConvergenceStudy(pool, f, AutomaticJacobian(f, 2), y0, 0, t1, options);
+    }
+    else if (method == 2) {
+        result = trapezoidalConvergenceStudy(pool, f, y0, 0, t1, options);
+    }
+    else {
+        result = rungeKuttaConvergenceStudy(pool, f, y0, 0, t1, options);
+    }
+
+    printConvergenceSummary(std::cout, result, options);
+    if (result.status == CONVERGENCE_STATUS_ERROR_SOLVER_FAILED) return;
+
     // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+    if (writeTrajectory(filename, result.solution) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
     }
-    file.close();
 
     std::cout << "Done." << std::endl;
 }
 
 
-int main() {
+void pararealOrbitDemo(int n, double days, int slices, int coarseSteps, const std::string &filename) {
+    const auto gravitationalConstant = 6.674e-11;
+    const auto earthMass = 5.97e24;
+    const auto dayLength = 86400;
+
+    // Coordinates are: sx, sy, vx, vy, as in the trapezoidal method orbit demo.
+    auto f = [=](double t, const double *y, double *dydt) {
+        auto radius = sqrt(pow(y[0], 2) + pow(y[1], 2));
+        auto acceleration = -gravitationalConstant * earthMass / pow(radius, 2);
+        dydt[0] = y[2];
+        dydt[1] = y[3];
+        dydt[2] = acceleration * y[0] / radius;
+        dydt[3] = acceleration * y[1] / radius;
+    };
+    std::vector<double> y0({0, 3.577e8, 1023, 0});
+
+    PararealOptions options;
+    options.slices = slices;
+    options.coarseSteps = coarseSteps;
+
+    // One slice per thread, compared with the serial solution of the fine method.
+    ThreadPool pool(slices);
+    Trajectory trajectory(n, 4);
+    PararealReport report;
+    auto start = std::chrono::steady_clock::now();
+    auto result = pararealMethod(pool, f, trajectory, y0, 0, days * dayLength, options, &report);
+    auto pararealSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Trajectory serial(n, 4);
+    start = std::chrono::steady_clock::now();
+    rungeKuttaMethod(f, serial, y0, 0, days * dayLength);
+    auto serialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto difference = 0.0;
+    for (auto i = 0; i < n; i++) {
+        for (auto j = 0; j < 4; j++) {
+            auto scale = 1 + std::fabs(serial(i, j));
+            difference = std::max(difference, std::fabs(trajectory(i, j) - serial(i, j)) / scale);
+        }
+    }
+
+    std::cout << "Parareal took " << report.iterations << " iterations and " << pararealSeconds
+              << " s; the serial Runge-Kutta method took " << serialSeconds << " s." << std::endl;
+    std::cout << "Largest relative difference from the serial solution: " << difference << std::endl;
+    if (result != PARAREAL_STATUS_OK) {
+        std::cerr << "Parareal method did not converge." << std::endl;
+        return;
+    }
+
+    // Write data to file.
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+        return;
+    }
+
+    std::cout << "Done." << std::endl;
+}
+
+
+int batch(const std::string &filename, int threads) {
+    std::vector<BatchJob> jobs;
+    std::string error;
+    if (readBatchJobs(filename, jobs, error) != BATCH_STATUS_OK) {
+        std::cerr << filename << ": " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    auto results = runBatchJobs(pool, jobs);
+    auto wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printBatchSummary(std::cout, jobs, results, wallSeconds);
+    for (auto &result : results) {
+        if (result.status != BATCH_STATUS_OK) return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char **argv) {
+    // `Chapter6 --batch jobs.txt [threads]` runs the jobs in the file (see `readBatchJobs`) instead of the menu. The
+    // default is one thread per hardware thread.
+    if (argc > 1) {
+        auto threads = argc > 3 ? std::atoi(argv[3]) : 0;
+        if (std::string(argv[1]) != "--batch" || argc < 3 || (argc > 3 && threads < 1)) {
+            std::cerr << "Usage: " << argv[0] << " [--batch jobs.txt [threads]], with at least 1 thread" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return batch(argv[2], threads);
+    }
+
     while (true) {
         std::cout << "Choose one:" << std::endl;
         std::cout << "    1) Backward Euler method demo" << std::endl;
@@ -302,12 +401,18 @@ int main() {
         std::cout << "    6) Trapezoidal method arbitrary system demo" << std::endl;
         std::cout << "    7) Runge-Kutta method arbitrary system demo" << std::endl;
         std::cout << "    8) Exit" << std::endl;
+        std::cout << "    9) Convergence study pendulum demo" << std::endl;
+        std::cout << "    10) Parareal orbit demo" << std::endl;
         std::cout << std::endl;
 
         std::cout << ": " << std::flush;
         int choice;
         std::cin >> choice;
-        if (choice == 1) {
+        // End of input (or anything but a number) ends the session, like Exit.
+        if (!std::cin || choice == 8) {
+            break;
+        }
+        else if (choice == 1) {
             int index;
             std::cout << "Enter the function number (1-4): " << std::flush;
             std::cin >> index;
@@ -442,33 +547,20 @@ int main() {
             std::cout << "Enter the number of dimensions: " << std::flush;
             std::cin >> m;
 
-            typedef exprtk::symbol_table<double> symbol_table_t;
-            typedef exprtk::expression<double> expression_t;
-            typedef exprtk::parser<double> parser_t;
-
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::vector<funcn> f(m);
+            std::vector<std::string> expressions(m);
             for (auto i = 0; i < m; i++) {
-                std::string expressionString;
                 std::cout << "Enter the expression for f" << i << "(t, y): " << std::flush;
-                std::getline(std::cin, expressionString);
-
-                f[i] = [=](double t, const std::vector<double> &y) {
-                    std::vector<double> yCopy = y;
-
-                    symbol_table_t symbolTable;
-                    symbolTable.add_constant("t", t);
-                    symbolTable.add_vector("y", yCopy);
-
-                    expression_t expression;
-                    expression.register_symbol_table(symbolTable);
-
-                    parser_t parser;
-                    parser.compile(expressionString, expression);
+                std::getline(std::cin, expressions[i]);
+            }
 
-                    return expression.value();
-                };
+            // Parse each expression once up front rather than on every evaluation.
+            ExpressionSystem system;
+            if (system.compile(expressions) != EXPRESSION_STATUS_OK) {
+                std::cerr << "Unable to parse expression " << system.error() << std::endl;
+                continue;
             }
+            auto f = [&system](double t, const double *y, double *dydt) { system(t, y, dydt); };
 
             std::vector<double> y0(m);
             for (auto i = 0; i < m; i++) {
@@ -499,33 +591,20 @@ int main() {
             std::cout << "Enter the number of dimensions: " << std::flush;
             std::cin >> m;
 
-            typedef exprtk::symbol_table<double> symbol_table_t;
-            typedef exprtk::expression<double> expression_t;
-            typedef exprtk::parser<double> parser_t;
-
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::vector<funcn> f(m);
+            std::vector<std::string> expressions(m);
             for (auto i = 0; i < m; i++) {
-                std::string expressionString;
                 std::cout << "Enter the expression for f" << i << "(t, y): " << std::flush;
-                std::getline(std::cin, expressionString);
-
-                f[i] = [=](double t, const std::vector<double> &y) {
-                    std::vector<double> yCopy = y;
-
-                    symbol_table_t symbolTable;
-                    symbolTable.add_constant("t", t);
-                    symbolTable.add_vector("y", yCopy);
-
-                    expression_t expression;
-                    expression.register_symbol_table(symbolTable);
-
-                    parser_t parser;
-                    parser.compile(expressionString, expression);
+                std::getline(std::cin, expressions[i]);
+            }
 
-                    return expression.value();
-                };
+            // Parse each expression once up front rather than on every evaluation.
+            ExpressionSystem system;
+            if (system.compile(expressions) != EXPRESSION_STATUS_OK) {
+                std::cerr << "Unable to parse expression " << system.error() << std::endl;
+                continue;
             }
+            auto f = [&system](double t, const double *y, double *dydt) { system(t, y, dydt); };
 
             std::vector<double> y0(m);
             for (auto i = 0; i < m; i++) {
@@ -551,8 +630,71 @@ int main() {
 
             rungeKuttaMethodSystemDemo(f, y0, n, t0, t1, filename);
         }
-        else if (choice == 8) {
-            break;
+        else if (choice == 9) {
+            int method;
+            std::cout << "Enter the method (1 backward Euler, 2 trapezoidal, 3 Runge-Kutta): " << std::flush;
+            std::cin >> method;
+
+            double theta0;
+            std::cout << "Enter initial angular displacement [rad]: " << std::flush;
+            std::cin >> theta0;
+
+            int n;
+            std::cout << "Enter number of time steps of the coarsest integration: " << std::flush;
+            std::cin >> n;
+
+            int levels;
+            std::cout << "Enter number of integrations (each with twice the steps of the previous one): " << std::flush;
+            std::cin >> levels;
+
+            double t1;
+            std::cout << "Enter total time [s]: " << std::flush;
+            std::cin >> t1;
+
+            double tolerance;
+            std::cout << "Enter error tolerance: " << std::flush;
+            std::cin >> tolerance;
+
+            int extrapolate;
+            std::cout << "Write the extrapolated solution (1) or the finest one (0): " << std::flush;
+            std::cin >> extrapolate;
+
+            std::string filename;
+            std::cout << "Enter filename: " << std::flush;
+            std::cin >> filename;
+
+            if (method < 1 || method > 3 || n < 2 || levels < 2) {
+                std::cout << "Invalid choice." << std::endl;
+                continue;
+            }
+            convergenceStudyPendulumDemo(method, theta0, n, levels, t1, tolerance, extrapolate != 0, filename);
+        }
+        else if (choice == 10) {
+            int n;
+            std::cout << "Enter number of time steps: " << std::flush;
+            std::cin >> n;
+
+            double days;
+            std::cout << "Enter total time [days]: " << std::flush;
+            std::cin >> days;
+
+            int slices;
+            std::cout << "Enter number of time slices (one thread each): " << std::flush;
+            std::cin >> slices;
+
+            int coarseSteps;
+            std::cout << "Enter number of coarse steps per slice: " << std::flush;
+            std::cin >> coarseSteps;
+
+            std::string filename;
+            std::cout << "Enter filename: " << std::flush;
+            std::cin >> filename;
+
+            if (n < 2 || slices < 1 || coarseSteps < 1) {
+                std::cout << "Invalid choice." << std::endl;
+                continue;
+            }
+            pararealOrbitDemo(n, days, slices, coarseSteps, filename);
         }
         else {
             std::cout << "Invalid choice." << std::endl;
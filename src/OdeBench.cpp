@@ -0,0 +1,472 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <numbers>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BackwardEulerMethod.h"
+#include "Dual.h"
+#include "IterationMatrix.h"
+#include "Jacobian.h"
+#include "RungeKuttaMethod.h"
+#include "TrapezoidalMethod.h"
+
+
+// Every allocation made through the global operator new is counted, so the benchmark can report how many a solver
+// call makes.
+static std::size_t allocationCount = 0;
+static std::size_t allocationBytes = 0;
+
+void *operator new(std::size_t size) {
+    allocationCount++;
+    allocationBytes += size;
+    if (auto pointer = std::malloc(size > 0 ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+/**
+ * Resets the peak resident set size of the process, so the next reading covers only what follows. Only supported on
+ * Linux; elsewhere the peak covers the whole run so far.
+ */
+static void resetPeakMemory() {
+#ifdef __linux__
+    std::ofstream file("/proc/self/clear_refs");
+    file << "5";
+#endif
+}
+
+/**
+ * @return the peak resident set size of the process in kB since the last `resetPeakMemory`, or 0 if unknown.
+ */
+static long peakMemory() {
+#ifdef __linux__
+    std::ifstream file("/proc/self/status");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+#endif
+    return 0;
+}
+
+
+/**
+ * Evaluation counts of a single solver run.
+ */
+struct BenchmarkCounters {
+    long rhsEvaluations = 0;
+    long jacobianEvaluations = 0;
+};
+
+
+/**
+ * The measurements of one solver on one system for one number of time points.
+ */
+struct BenchmarkResult {
+    std::string system;
+    std::string solver;
+    std::size_t dimension = 0;
+    int n = 0;
+    int status = 0;
+
+    // The fastest of the repetitions, in seconds.
+    double seconds = 0;
+
+    BenchmarkCounters counters;
+    std::size_t allocations = 0;
+    std::size_t allocatedBytes = 0;
+    long peakMemory = 0;
+};
+
+
+// Each configuration is run this many times and the fastest run is reported.
+const auto repetitions = 3;
+
+
+/**
+ * Times `run`, which solves the problem once and returns the solver's status.
+ * @param run called as `run(counters)`, counting its evaluations in `counters`.
+ */
+template <typename Run>
+BenchmarkResult measure(const std::string &system, const std::string &solver, std::size_t dimension, int n,
+                        Run &&run) {
+    BenchmarkResult result;
+    result.system = system;
+    result.solver = solver;
+    result.dimension = dimension;
+    result.n = n;
+    result.seconds = INFINITY;
+
+    for (auto repetition = 0; repetition < repetitions; repetition++) {
+        BenchmarkCounters counters;
+        resetPeakMemory();
+        auto allocations = allocationCount;
+        auto bytes = allocationBytes;
+
+        auto start = std::chrono::steady_clock::now();
+        result.status = run(counters);
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Every repetition does the same work, so the counts of the first one are kept.
+        if (repetition == 0) {
+            result.counters = counters;
+            result.allocations = allocationCount - allocations;
+            result.allocatedBytes = allocationBytes - bytes;
+            result.peakMemory = peakMemory();
+        }
+        result.seconds = std::min(result.seconds, seconds);
+    }
+
+    std::cerr << system << " (" << dimension << ") " << solver << " n = " << n << ": " << result.seconds << " s"
+              << std::endl;
+    return result;
+}
+
+
+/**
+ * Benchmarks the three solvers on a system written for a generic scalar type, so that its Jacobian can be computed
+ * by `AutomaticJacobian` for the backward Euler method.
+ */
+template <typename F>
+void benchmarkSystem(std::vector<BenchmarkResult> &results, const std::string &name, F f,
+                     const std::vector<double> &y0, double t0, double t1, const std::vector<int> &ns) {
+    auto m = y0.size();
+
+    for (auto n : ns) {
+        results.push_back(measure(name, "trapezoidalMethod", m, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                f(t, y, dydt);
+            };
+            Trajectory trajectory(n, m);
+            return (int) trapezoidalMethod(counted, trajectory, y0, t0, t1);
+        }));
+
+        results.push_back(measure(name, "rungeKuttaMethod", m, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                f(t, y, dydt);
+            };
+            Trajectory trajectory(n, m);
+            return (int) rungeKuttaMethod(counted, trajectory, y0, t0, t1);
+        }));
+
+        results.push_back(measure(name, "backwardEulerMethod", m, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                f(t, y, dydt);
+            };
+            AutomaticJacobian jacobian(f, m);
+            auto countedJacobian = [&](double t, const double *y, double *fy) {
+                counters.jacobianEvaluations++;
+                jacobian(t, y, fy);
+            };
+            Trajectory trajectory(n, m);
+            return (int) backwardEulerMethod(counted, countedJacobian, trajectory, y0, t0, t1);
+        }));
+    }
+}
+
+
+/**
+ * Benchmarks the three solvers on a system of fixed dimension `N`, and the trapezoidal and Runge-Kutta methods also in
+ * their forms specialized for the dimension.
+ */
+template <std::size_t N, typename F>
+void benchmarkSystem(std::vector<BenchmarkResult> &results, const std::string &name, F f,
+                     const std::array<double, N> &y0, double t0, double t1, const std::vector<int> &ns) {
+    benchmarkSystem(results, name, f, std::vector<double>(y0.begin(), y0.end()), t0, t1, ns);
+
+    for (auto n : ns) {
+        results.push_back(measure(name, "trapezoidalMethod<N>", N, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                f(t, y, dydt);
+            };
+            Trajectory trajectory(n, N);
+            return (int) trapezoidalMethod(counted, trajectory, y0, t0, t1);
+        }));
+
+        results.push_back(measure(name, "rungeKuttaMethod<N>", N, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                f(t, y, dydt);
+            };
+            Trajectory trajectory(n, N);
+            return (int) rungeKuttaMethod(counted, trajectory, y0, t0, t1);
+        }));
+    }
+}
+
+
+/**
+ * Benchmarks the three solvers on a scalar ODE y' = f(t, y) written for a generic scalar type. The explicit solvers
+ * see it as a system of dimension 1, the backward Euler method uses its scalar form with the derivative from
+ * `derivative`.
+ */
+template <typename F>
+void benchmarkScalar(std::vector<BenchmarkResult> &results, const std::string &name, F f, double y0, double t0,
+                     double t1, const std::vector<int> &ns) {
+    for (auto n : ns) {
+        results.push_back(measure(name, "trapezoidalMethod", 1, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                dydt[0] = f(t, y[0]);
+            };
+            Trajectory trajectory(n, 1);
+            return (int) trapezoidalMethod(counted, trajectory, {y0}, t0, t1);
+        }));
+
+        results.push_back(measure(name, "rungeKuttaMethod", 1, n, [&](BenchmarkCounters &counters) {
+            auto counted = [&](double t, const double *y, double *dydt) {
+                counters.rhsEvaluations++;
+                dydt[0] = f(t, y[0]);
+            };
+            Trajectory trajectory(n, 1);
+            return (int) rungeKuttaMethod(counted, trajectory, {y0}, t0, t1);
+        }));
+
+        results.push_back(measure(name, "backwardEulerMethod", 1, n, [&](BenchmarkCounters &counters) {
+            auto fy = derivative(f);
+            func1 counted = [&](double t, double y) {
+                counters.rhsEvaluations++;
+                return f(t, y);
+            };
+            func1 countedDerivative = [&](double t, double y) {
+                counters.jacobianEvaluations++;
+                return fy(t, y);
+            };
+            std::vector<double> t(n);
+            std::vector<double> y(n);
+            return (int) backwardEulerMethod(counted, countedDerivative, t, y, y0, t0, t1);
+        }));
+    }
+}
+
+
+/**
+ * Benchmarks the backward Euler method on the heat equation with a cubic sink, y' = c (y[j-1] - 2 y[j] + y[j+1]) - y^3
+ * on m interior points with zero boundary values, with the iteration matrix stored dense, banded and sparse, and sparse
+ * with a finite difference Jacobian. All take the same steps, so only the cost of forming and factoring the iteration
+ * matrix differs. The dense form is only run up to dimension `maxDense`.
+ */
+void benchmarkHeatEquation(std::vector<BenchmarkResult> &results, const std::vector<std::size_t> &ms,
+                           std::size_t maxDense, int n) {
+    for (auto m : ms) {
+        const auto dx = 1.0 / (m + 1);
+        const auto c = 1 / (dx * dx);
+        std::vector<double> y0(m);
+        for (std::size_t j = 0; j < m; j++) {
+            y0[j] = sin(std::numbers::pi * (j + 1) * dx);
+        }
+
+        auto f = [=](double t, const double *y, double *dydt) {
+            for (std::size_t j = 0; j < m; j++) {
+                auto left = j > 0 ? y[j - 1] : 0.0;
+                auto right = j + 1 < m ? y[j + 1] : 0.0;
+                dydt[j] = c * (left - 2 * y[j] + right) - y[j] * y[j] * y[j];
+            }
+        };
+        // The derivative of yj' with respect to yj.
+        auto diagonal = [=](const double *y, std::size_t j) { return -2 * c - 3 * y[j] * y[j]; };
+
+        // Runs the backward Euler method with the Jacobian `fy` in the layout of `matrix`.
+        auto run = [&](const std::string &solver, auto matrix, auto fy) {
+            results.push_back(measure("heat", solver, m, n, [&](BenchmarkCounters &counters) {
+                auto counted = [&](double t, const double *y, double *dydt) {
+                    counters.rhsEvaluations++;
+                    f(t, y, dydt);
+                };
+                auto countedJacobian = [&](double t, const double *y, double *jacobian) {
+                    counters.jacobianEvaluations++;
+                    fy(t, y, jacobian);
+                };
+                NewtonWorkspace workspace(matrix);
+                Trajectory trajectory(n, m);
+                return (int) backwardEulerMethod(counted, countedJacobian, trajectory, y0, 0, 0.1, 1e-10, 10,
+                                                 nullptr, workspace);
+            }));
+        };
+
+        if (m <= maxDense) {
+            run("backwardEulerMethod<dense>", DenseIterationMatrix(), [=](double t, const double *y, double *jacobian) {
+                std::fill(jacobian, jacobian + m * m, 0.0);
+                for (std::size_t j = 0; j < m; j++) {
+                    if (j > 0) jacobian[j * m + j - 1] = c;
+                    jacobian[j * m + j] = diagonal(y, j);
+                    if (j + 1 < m) jacobian[j * m + j + 1] = c;
+                }
+            });
+        }
+
+        // Each row holds the entries for y[j-1], y[j] and y[j+1]; those outside the matrix are ignored.
+        run("backwardEulerMethod<banded>", BandedIterationMatrix(1, 1), [=](double t, const double *y,
+                                                                             double *jacobian) {
+            for (std::size_t j = 0; j < m; j++) {
+                jacobian[3 * j] = c;
+                jacobian[3 * j + 1] = diagonal(y, j);
+                jacobian[3 * j + 2] = c;
+            }
+        });
+
+        SparsePattern pattern;
+        pattern.m = m;
+        pattern.rowStart.push_back(0);
+        for (std::size_t j = 0; j < m; j++) {
+            if (j > 0) pattern.columns.push_back(j - 1);
+            pattern.columns.push_back(j);
+            if (j + 1 < m) pattern.columns.push_back(j + 1);
+            pattern.rowStart.push_back(pattern.columns.size());
+        }
+        run("backwardEulerMethod<sparse>", SparseIterationMatrix(pattern), [=](double t, const double *y,
+                                                                              double *jacobian) {
+            for (std::size_t j = 0, p = 0; j < m; j++) {
+                if (j > 0) jacobian[p++] = c;
+                jacobian[p++] = diagonal(y, j);
+                if (j + 1 < m) jacobian[p++] = c;
+            }
+        });
+
+        // The same with the Jacobian approximated by colored finite differences, four evaluations of `f` each (which
+        // show in the time but not in the counted evaluations).
+        run("backwardEulerMethod<sparse, finite differences>", SparseIterationMatrix(pattern),
+            SparseFiniteDifferenceJacobian(f, pattern));
+    }
+}
+
+
+/**
+ * Write the results as a JSON document.
+ */
+void writeJson(std::ostream &stream, const std::vector<BenchmarkResult> &results) {
+    stream << "{\n  \"benchmark\": \"ode_bench\",\n  \"repetitions\": " << repetitions << ",\n  \"results\": [";
+    for (auto i = 0; i < results.size(); i++) {
+        const auto &result = results[i];
+        auto steps = result.n - 1;
+        auto perSecond = [&](double count) { return result.seconds > 0 ? count / result.seconds : 0.0; };
+
+        stream << (i > 0 ? "," : "") << "\n    {"
+               << "\"system\": \"" << result.system << "\", "
+               << "\"solver\": \"" << result.solver << "\", "
+               << "\"dimension\": " << result.dimension << ", "
+               << "\"n\": " << result.n << ", "
+               << "\"status\": " << result.status << ", "
+               << "\"seconds\": " << result.seconds << ", "
+               << "\"steps_per_second\": " << perSecond(steps) << ", "
+               << "\"rhs_evaluations\": " << result.counters.rhsEvaluations << ", "
+               << "\"rhs_evaluations_per_second\": " << perSecond((double) result.counters.rhsEvaluations) << ", "
+               << "\"jacobian_evaluations\": " << result.counters.jacobianEvaluations << ", "
+               << "\"allocations\": " << result.allocations << ", "
+               << "\"allocated_bytes\": " << result.allocatedBytes << ", "
+               << "\"peak_rss_kb\": " << result.peakMemory << "}";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+
+/**
+ * Times the solvers on the demo systems and writes the results as JSON, to the file named by the first argument or to
+ * standard output. Progress is reported on standard error.
+ */
+int main(int argc, char *argv[]) {
+    const std::vector<int> ns({1000, 10000, 100000});
+    std::vector<BenchmarkResult> results;
+
+    // The systems of the Chapter6 demos, written for a generic scalar type.
+    const auto gravity = 9.81, length = 1.0, drag = 0.1;
+    benchmarkSystem(results, "pendulum", [=](double t, const auto *y, auto *dydt) {
+        dydt[0] = y[1];
+        dydt[1] = -(gravity / length) * sin(y[0]) - drag * y[1];
+    }, std::array<double, 2>({1, 0}), 0, 10, ns);
+
+    const auto gm = 6.674e-11 * 5.97e24;
+    benchmarkSystem(results, "orbit", [=](double t, const auto *y, auto *dydt) {
+        auto radius = sqrt(y[0] * y[0] + y[1] * y[1]);
+        auto acceleration = -gm / (radius * radius);
+        dydt[0] = y[2];
+        dydt[1] = y[3];
+        dydt[2] = acceleration * y[0] / radius;
+        dydt[3] = acceleration * y[1] / radius;
+    }, std::array<double, 4>({0, 3.577e8, 1023, 0}), 0, 27 * 86400.0, ns);
+
+    const auto b = 0.5, k = 0.1;
+    benchmarkSystem(results, "sir", [=](double t, const auto *y, auto *dydt) {
+        auto infections = b * y[0] * y[1];
+        auto recoveries = k * y[1];
+        dydt[0] = -infections;
+        dydt[1] = infections - recoveries;
+        dydt[2] = recoveries;
+    }, std::array<double, 3>({0.99, 0.01, 0}), 0, 100, ns);
+
+    benchmarkSystem(results, "predator_prey", [](double t, const auto *y, auto *dydt) {
+        dydt[0] = 2.0 * y[0] - 0.01 * y[0] * y[1];
+        dydt[1] = -1.0 * y[1] + 0.01 * y[0] * y[1];
+    }, std::array<double, 2>({500, 360}), 0, 10, ns);
+
+    // The stiff scalar functions of the backward Euler demo.
+    benchmarkScalar(results, "stiff_1", [](double t, auto y) { return -10 * y; }, 1, 0, 1, ns);
+    benchmarkScalar(results, "stiff_2", [](double t, auto y) { return (1 + (8 - 9 * y) * y) * y; }, 0.5, 0, 1, ns);
+    benchmarkScalar(results, "stiff_3", [](double t, auto y) { return -y * y; }, 1, 0, 1, ns);
+    benchmarkScalar(results, "stiff_4", [](double t, auto y) { return -y / (1 + y * y); }, 1, 0, 1, ns);
+
+    // A heat equation discretized on m points, to see how the solvers scale with the dimension.
+    for (std::size_t m : {4, 16, 64, 128}) {
+        std::vector<double> y0(m);
+        for (auto j = 0; j < m; j++) {
+            y0[j] = sin(std::numbers::pi * (j + 1) / (m + 1));
+        }
+        benchmarkSystem(results, "diffusion", [m](double t, const auto *y, auto *dydt) {
+            for (std::size_t j = 0; j < m; j++) {
+                auto left = j > 0 ? y[j - 1] : 0 * y[j];
+                auto right = j + 1 < m ? y[j + 1] : 0 * y[j];
+                dydt[j] = left - 2 * y[j] + right;
+            }
+        }, y0, 0, 1, {1000});
+    }
+
+    // The same with a cubic sink and a stiff scaling, to compare the storage of the backward Euler method's iteration
+    // matrix as the dimension grows.
+    benchmarkHeatEquation(results, {64, 256, 1024, 16384, 131072}, 1024, 101);
+
+    if (argc > 1) {
+        std::ofstream file(argv[1], std::ios_base::out);
+        if (!file.is_open()) {
+            std::cerr << "Unable to open file " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        writeJson(file, results);
+    }
+    else {
+        writeJson(std::cout, results);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,24 @@
+#include "ParameterSweep.h"
+
+
+/**
+ * Builds the Cartesian product of several parameter axes. For axes {{1, 2}, {10, 20, 30}} the result is
+ * {{1, 10}, {1, 20}, {1, 30}, {2, 10}, {2, 20}, {2, 30}}: the last axis varies fastest.
+ * @param axes the values of each parameter.
+ * @return one parameter vector per grid point.
+ */
+std::vector<std::vector<double>> parameterGrid(const std::vector<std::vector<double>> &axes) {
+    std::vector<std::vector<double>> grid({{}});
+    for (const auto &axis : axes) {
+        std::vector<std::vector<double>> next;
+        next.reserve(grid.size() * axis.size());
+        for (const auto &point : grid) {
+            for (auto value : axis) {
+                next.push_back(point);
+                next.back().push_back(value);
+            }
+        }
+        grid.swap(next);
+    }
+    return grid;
+}
@@ -3,48 +3,52 @@
 #include <vector>
 #include <fstream>
 
-#include "TrapezoidalMethod.h"
+#include "EnsembleMethod.h"
+#include "TrajectoryFile.h"
 #include "Util.h"
 
 
-void predatorPrey(int n, double prey, double predator, double t0, double t1, const std::string &filename) {
+void predatorPrey(int n, const std::vector<int> &prey, const std::vector<int> &predator, double t0, double t1,
+                  const std::vector<std::string> &filenames) {
     const auto a = 2.0;
     const auto b = 0.01;
     const auto c = 1.0;
     const auto d = 0.01;
 
-    // Vector of functions. The first entry is f1, second is f2, etc.
-    std::vector<funcn> f({
-        [=](double t, const std::vector<double> &y) { return a * y[0] - b * y[0] * y[1]; },
-        [=](double t, const std::vector<double> &y) { return -c * y[1] + d * y[0] * y[1]; }
-    });
+    // Coordinates are: prey, predator. Every initial condition is evaluated at once, lane by lane.
+    auto f = [=](double t, const double *y, double *dydt, std::size_t lanes) {
+        for (std::size_t l = 0; l < lanes; l++) {
+            auto x = y[l];
+            auto z = y[lanes + l];
+            dydt[l] = a * x - b * x * z;
+            dydt[lanes + l] = -c * z + d * x * z;
+        }
+    };
 
-    // Vector to store result.
-    std::vector<double> t(n);
-    std::vector<std::vector<double>> y(n);
+    // Trajectories to store results.
+    std::vector<Trajectory> trajectories(prey.size(), Trajectory(n, 2));
 
     // Initial conditions.
-    std::vector<double> y0({prey, predator});
+    std::vector<std::vector<double>> y0;
+    for (auto i = 0; i < prey.size(); i++) {
+        y0.push_back({(double) prey[i], (double) predator[i]});
+    }
 
-    auto result = trapezoidalMethod(f, t, y, y0, t0, t1);
-    if (result != TRAPEZOIDAL_STATUS_OK) {
+    auto result = ensembleMethod(ENSEMBLE_SCHEME_TRAPEZOIDAL, f, trajectories, y0, t0, t1);
+    if (result != ENSEMBLE_STATUS_OK) {
         std::cerr << "Trapezoidal method failed. Dimension mismatch!" << std::endl;
         return;
     }
 
-    std::ofstream file(filename, std::ios_base::out);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return;
-    }
+    for (auto i = 0; i < trajectories.size(); i++) {
+        // Write data to file.
+        if (writeTrajectory(filenames[i], trajectories[i]) != TRAJECTORY_FILE_STATUS_OK) {
+            std::cerr << "Unable to write file " << filenames[i] << std::endl;
+            continue;
+        }
 
-    // Write data to file.
-    for (auto i = 0; i < t.size(); i++) {
-        file << t[i] << ", " << y[i] << std::endl;
+        std::cout << "Done." << std::endl;
     }
-    file.close();
-
-    std::cout << "Done." << std::endl;
 }
 
 
@@ -60,9 +64,12 @@ int main() {
     auto t0 = 0;
     auto t1 = 10;
 
+    std::vector<std::string> filenames;
     for (auto i = 0; i < x0.size(); i++) {
-        predatorPrey(n, x0[i], y0[i], t0, t1, "../output/" + std::to_string(x0[i]) + "_" + std::to_string(y0[i]) + ".txt");
+        filenames.push_back("../output/" + std::to_string(x0[i]) + "_" + std::to_string(y0[i]) + ".bin");
     }
 
+    predatorPrey(n, x0, y0, t0, t1, filenames);
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,120 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CsvWriter.h"
+#include "ParameterSweep.h"
+#include "TrajectoryFile.h"
+#include "TrapezoidalMethod.h"
+#include "Util.h"
+
+
+/**
+ * Summary of a single SIR run.
+ */
+struct SIRResult {
+    double peakInfected = 0;
+    double peakTime = 0;
+};
+
+
+SIRResult sir(int n, double t0, double t1, double s0, double i0, double r0, double b, double k,
+              const std::string &filename) {
+    // Normalize values.
+    const auto total = s0 + i0 + r0;
+
+    // Coordinates are: s, i, r.
+    auto f = [=](double t, const double *y, double *dydt) {
+        auto infections = b * y[0] * y[1];
+        auto recoveries = k * y[1];
+        dydt[0] = -infections;
+        dydt[1] = infections - recoveries;
+        dydt[2] = recoveries;
+    };
+
+    // Trajectory to store result.
+    Trajectory trajectory(n, 3);
+
+    // Initial conditions.
+    std::vector<double> y0({s0 / total, i0 / total, r0 / total});
+
+    trapezoidalMethod(f, trajectory, y0, t0, t1);
+
+    // Undo normalization.
+    for (double &value : trajectory.data()) {
+        value *= total;
+    }
+
+    SIRResult result;
+    for (auto i = 0; i < trajectory.size(); i++) {
+        if (trajectory(i, 1) > result.peakInfected) {
+            result.peakInfected = trajectory(i, 1);
+            result.peakTime = trajectory.time(i);
+        }
+    }
+
+    // Write data to file.
+    if (writeTrajectory(filename, trajectory) != TRAJECTORY_FILE_STATUS_OK) {
+        std::cerr << "Unable to write file " << filename << std::endl;
+    }
+
+    return result;
+}
+
+
+int main(int argc, char **argv) {
+    // The number of threads may be given as the only argument. The default is one per hardware thread.
+    auto threads = argc > 1 ? std::atoi(argv[1]) : 0;
+    if (argc > 1 && threads < 1) {
+        std::cerr << "Usage: " << argv[0] << " [threads], with at least 1 thread" << std::endl;
+        return EXIT_FAILURE;
+    }
+    ThreadPool pool(threads);
+
+    auto n = 10000;
+    auto t0 = 0.0;
+    auto t1 = 100.0;
+    auto s0 = 990.0;
+    auto i0 = 10.0;
+    auto r0 = 0.0;
+
+    // Grid of infection rates b and recovery rates k.
+    std::vector<double> bValues;
+    std::vector<double> kValues;
+    for (auto i = 1; i <= 10; i++) {
+        bValues.push_back(0.1 * i);
+        kValues.push_back(0.05 * i);
+    }
+    auto grid = parameterGrid({bValues, kValues});
+
+    auto results = parameterSweep(pool, grid, [&](std::size_t index, const std::vector<double> &parameters) {
+        std::ostringstream filename;
+        filename << "../output/sir_" << parameters[0] << "_" << parameters[1] << ".txt";
+        return sir(n, t0, t1, s0, i0, r0, parameters[0], parameters[1], filename.str());
+    });
+
+    std::ofstream file("../output/sir_sweep.txt", std::ios_base::out);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file ../output/sir_sweep.txt" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // One line per run: b, k, peak number of infected, time of the peak.
+    {
+        CsvWriter writer(file);
+        for (auto i = 0; i < grid.size(); i++) {
+            writer.values(grid[i]);
+            writer.value(results[i].peakInfected);
+            writer.value(results[i].peakTime);
+            writer.endRow();
+        }
+    }
+    file.close();
+
+    std::cout << "Done." << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include "SolverStats.h"
+
+
+namespace {
+
+/**
+ * Write a double with the shortest text that reads back as the same value.
+ */
+void writeNumber(std::ostream &stream, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    stream.write(buffer, result.ptr - buffer);
+}
+
+/**
+ * @return the time a timed call spends reading the clock, measured once on first use.
+ */
+double clockOverhead() {
+    static const auto overhead = [] {
+        const auto repetitions = 1000;
+
+        // The fastest of several batches, so a batch interrupted by the scheduler does not count.
+        auto best = std::numeric_limits<double>::infinity();
+        for (auto batch = 0; batch < 10; batch++) {
+            auto sum = 0.0;
+            for (auto i = 0; i < repetitions; i++) {
+                auto start = std::chrono::steady_clock::now();
+                sum += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            best = std::min(best, sum / repetitions);
+        }
+        return best;
+    }();
+    return overhead;
+}
+
+} // namespace
+
+
+/**
+ * Add a timed call that started at `start` and has just finished to `stats`, less the time spent reading the clock.
+ */
+void recordTimedCall(OperationStats &stats, std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.timedSeconds += std::max(elapsed - clockOverhead(), 0.0);
+    stats.timedCalls++;
+}
+
+
+/**
+ * Write the statistics as a JSON object: the counters, the Newton histogram and the estimated seconds spent in each
+ * operation, plus the remainder of the wall-clock time if `profileSolver` measured it.
+ * @param stream the stream to write to.
+ * @param stats the statistics to write.
+ * @return the stream.
+ */
+std::ostream &writeSolverStats(std::ostream &stream, const SolverStats &stats) {
+    stream << "{\"rhsEvaluations\": " << stats.rhs.calls + stats.jacobianRhs.calls
+           << ", \"jacobianEvaluations\": " << stats.jacobian.calls
+           << ", \"jacobianRhsEvaluations\": " << stats.jacobianRhs.calls
+           << ", \"linearSolves\": " << stats.linearAlgebra.calls
+           << ", \"observerCalls\": " << stats.output.calls
+           << ", \"steps\": " << stats.steps
+           << ", \"rejectedSteps\": " << stats.rejectedSteps
+           << ", \"newtonIterations\": " << stats.newtonIterations
+           << ", \"newtonFailures\": " << stats.newtonFailures
+           << ", \"newtonHistogram\": [";
+    for (std::size_t i = 0; i < stats.newtonHistogram.size(); i++) {
+        if (i > 0) stream << ", ";
+        stream << stats.newtonHistogram[i];
+    }
+
+    auto rhs = stats.rhs.seconds();
+    auto jacobian = stats.jacobian.seconds();
+    auto linearAlgebra = stats.linearAlgebra.seconds();
+    auto output = stats.output.seconds();
+
+    stream << "], \"seconds\": {\"rhs\": ";
+    writeNumber(stream, rhs);
+    stream << ", \"jacobian\": ";
+    writeNumber(stream, jacobian);
+    stream << ", \"linearAlgebra\": ";
+    writeNumber(stream, linearAlgebra);
+    stream << ", \"output\": ";
+    writeNumber(stream, output);
+    if (stats.wallSeconds > 0) {
+        auto other = stats.wallSeconds - rhs - jacobian - linearAlgebra - output;
+        stream << ", \"other\": ";
+        writeNumber(stream, std::max(other, 0.0));
+        stream << ", \"wall\": ";
+        writeNumber(stream, stats.wallSeconds);
+    }
+    return stream << "}}";
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+
+/**
+ * @param threads the number of worker threads. Zero uses one per hardware thread.
+ */
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+        this->threads.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+
+/**
+ * @return the number of worker threads.
+ */
+std::size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+
+/**
+ * Run `task(i)` for every i in 0, ..., count - 1 and wait for all of them to finish. If any task throws, the first
+ * exception is rethrown here once the others have finished.
+ * @param count the number of tasks.
+ * @param task the task to run for each index.
+ */
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t index)> &task) {
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // A worker may still be on its way out of the previous batch. Wait for it so it cannot pick up the new tasks with
+    // the old task function.
+    done.wait(lock, [&] { return active == 0; });
+
+    // Give each worker a contiguous block of indices.
+    auto n = workers.size();
+    for (std::size_t w = 0; w < n; w++) {
+        std::lock_guard<std::mutex> queueLock(workers[w]->mutex);
+        for (auto i = count * w / n; i < count * (w + 1) / n; i++) {
+            workers[w]->queue.push_back(i);
+        }
+    }
+
+    this->task = &task;
+    remaining = count;
+    error = nullptr;
+    generation++;
+    wake.notify_all();
+
+    done.wait(lock, [&] { return remaining == 0 && active == 0; });
+    this->task = nullptr;
+
+    if (error) std::rethrow_exception(error);
+}
+
+
+/**
+ * The loop each worker thread runs: wait for a batch, then run tasks until none are left anywhere.
+ */
+void ThreadPool::run(std::size_t self) {
+    std::size_t seen = 0;
+    while (true) {
+        const std::function<void(std::size_t)> *current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = task;
+            active++;
+        }
+
+        std::size_t index;
+        while (current && take(self, index)) {
+            std::exception_ptr exception;
+            try {
+                (*current)(index);
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (exception && !error) error = exception;
+            remaining--;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+        }
+        done.notify_all();
+    }
+}
+
+
+/**
+ * Take the next task for worker `self`: the front of its own queue, or else the back of another worker's queue.
+ * @return false if every queue is empty.
+ */
+bool ThreadPool::take(std::size_t self, std::size_t &index) {
+    {
+        std::lock_guard<std::mutex> lock(workers[self]->mutex);
+        if (!workers[self]->queue.empty()) {
+            index = workers[self]->queue.front();
+            workers[self]->queue.pop_front();
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < workers.size(); offset++) {
+        auto &victim = *workers[(self + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            index = victim.queue.back();
+            victim.queue.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "TrajectoryFile.h"
+#include "Util.h"
+
+// Rows are converted into a buffer of this many values before each write, so large files go out in big blocks.
+static const std::size_t bufferSize = 1 << 16;
+
+
+/**
+ * Write the rows of a trajectory in the binary format, converting them to `Value` (float or double).
+ */
+template <typename Value>
+static bool writeRows(std::ofstream &file, const Trajectory &trajectory, bool timeColumn) {
+    auto m = trajectory.dimension();
+    auto columns = m + (timeColumn ? 1 : 0);
+    auto rowsPerBlock = std::max<std::size_t>(1, bufferSize / std::max<std::size_t>(1, columns));
+
+    std::vector<Value> buffer;
+    buffer.reserve(rowsPerBlock * columns);
+    for (std::size_t i = 0; i < trajectory.size(); i++) {
+        if (timeColumn) buffer.push_back((Value) trajectory.time(i));
+        for (std::size_t j = 0; j < m; j++) {
+            buffer.push_back((Value) trajectory(i, j));
+        }
+
+        if (buffer.size() >= rowsPerBlock * columns || i + 1 == trajectory.size()) {
+            auto bytes = (std::streamsize) (buffer.size() * sizeof(Value));
+            file.write(reinterpret_cast<const char *>(buffer.data()), bytes);
+            buffer.clear();
+        }
+    }
+    return (bool) file;
+}
+
+
+/**
+ * Write a trajectory to a file, either as CSV (one `t, y1, ..., yn` line per time point) or in the binary format
+ * described by `TrajectoryFileHeader`.
+ * @param filename the file to write.
+ * @param trajectory the trajectory to write.
+ * @param format the file format.
+ * @param type the value type of binary files.
+ * @param timeLayout how binary files store the time points. The uniform layout should only be used for fixed-step
+ *        results.
+ * @return STATUS_OK if the file was written, STATUS_ERROR_OPEN_FAILED if it could not be opened or
+ *         STATUS_ERROR_IO_FAILED if writing failed.
+ */
+TrajectoryFileStatus writeTrajectory(const std::string &filename, const Trajectory &trajectory,
+                                     TrajectoryFileFormat format, TrajectoryFileType type,
+                                     TrajectoryFileTimeLayout timeLayout) {
+    if (format == TRAJECTORY_FILE_FORMAT_AUTOMATIC) {
+        auto binary = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0;
+        format = binary ? TRAJECTORY_FILE_FORMAT_BINARY : TRAJECTORY_FILE_FORMAT_CSV;
+    }
+
+    if (format == TRAJECTORY_FILE_FORMAT_CSV) {
+        std::ofstream file(filename, std::ios_base::out);
+        if (!file.is_open()) return TRAJECTORY_FILE_STATUS_ERROR_OPEN_FAILED;
+
+        file << trajectory;
+        file.close();
+        return file ? TRAJECTORY_FILE_STATUS_OK : TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+    }
+
+    std::ofstream file(filename, std::ios_base::out | std::ios_base::binary);
+    if (!file.is_open()) return TRAJECTORY_FILE_STATUS_ERROR_OPEN_FAILED;
+
+    TrajectoryFileHeader header;
+    header.type = type;
+    header.timeLayout = timeLayout;
+    header.dimension = trajectory.dimension();
+    header.count = trajectory.size();
+    if (trajectory.size() > 0) header.t0 = trajectory.time(0);
+    if (trajectory.size() > 1) {
+        header.h = (trajectory.time(trajectory.size() - 1) - trajectory.time(0)) / (double) (trajectory.size() - 1);
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    auto timeColumn = timeLayout == TRAJECTORY_FILE_TIME_LAYOUT_COLUMN;
+    auto written = false;
+    if (type == TRAJECTORY_FILE_TYPE_FLOAT64 && !timeColumn && trajectory.layout() == TRAJECTORY_LAYOUT_ROW_MAJOR) {
+        // The file rows are exactly the trajectory's storage.
+        auto data = trajectory.data();
+        file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) (data.size() * sizeof(double)));
+        written = (bool) file;
+    }
+    else if (type == TRAJECTORY_FILE_TYPE_FLOAT64) {
+        written = writeRows<double>(file, trajectory, timeColumn);
+    }
+    else {
+        written = writeRows<float>(file, trajectory, timeColumn);
+    }
+
+    file.close();
+    return written && file ? TRAJECTORY_FILE_STATUS_OK : TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+}
+
+
+/**
+ * Read a trajectory from a binary trajectory file.
+ * @param filename the file to read.
+ * @param trajectory the trajectory to store the result in (in row-major layout).
+ * @return STATUS_OK if the file was read, STATUS_ERROR_OPEN_FAILED if it could not be opened,
+ *         STATUS_ERROR_IO_FAILED if it is shorter than its header says (checked before anything is allocated) or
+ *         STATUS_ERROR_INVALID_FORMAT if it is not a trajectory file.
+ */
+TrajectoryFileStatus readTrajectory(const std::string &filename, Trajectory &trajectory) {
+    std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open()) return TRAJECTORY_FILE_STATUS_ERROR_OPEN_FAILED;
+
+    TrajectoryFileHeader expected;
+    TrajectoryFileHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file) return TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != 1 ||
+        (header.type != TRAJECTORY_FILE_TYPE_FLOAT64 && header.type != TRAJECTORY_FILE_TYPE_FLOAT32) ||
+        header.timeLayout > TRAJECTORY_FILE_TIME_LAYOUT_UNIFORM) {
+        return TRAJECTORY_FILE_STATUS_ERROR_INVALID_FORMAT;
+    }
+
+    auto timeColumn = header.timeLayout == TRAJECTORY_FILE_TIME_LAYOUT_COLUMN;
+    auto columns = header.dimension + (timeColumn ? 1 : 0);
+    auto size = header.type == TRAJECTORY_FILE_TYPE_FLOAT64 ? sizeof(double) : sizeof(float);
+
+    // Check the size the header claims against the file before allocating for it. Rows without any column cannot be
+    // told apart, so a nonempty trajectory needs at least one.
+    auto start = file.tellg();
+    file.seekg(0, std::ios_base::end);
+    auto remaining = (std::uint64_t) (file.tellg() - start);
+    file.seekg(start);
+    if (!file) return TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+    if (header.count > 0 && columns == 0) return TRAJECTORY_FILE_STATUS_ERROR_INVALID_FORMAT;
+    if (header.count > 0 && (columns > remaining / size || header.count > remaining / (columns * size))) {
+        return TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+    }
+
+    std::vector<char> bytes(header.count * columns * size);
+    file.read(bytes.data(), (std::streamsize) bytes.size());
+    if (!file) return TRAJECTORY_FILE_STATUS_ERROR_IO_FAILED;
+
+    trajectory.setLayout(TRAJECTORY_LAYOUT_ROW_MAJOR);
+    trajectory.resize(header.count, header.dimension);
+    for (std::size_t i = 0; i < header.count; i++) {
+        for (std::size_t c = 0; c < columns; c++) {
+            double value;
+            if (header.type == TRAJECTORY_FILE_TYPE_FLOAT64) {
+                std::memcpy(&value, bytes.data() + (i * columns + c) * size, sizeof(double));
+            }
+            else {
+                float single;
+                std::memcpy(&single, bytes.data() + (i * columns + c) * size, sizeof(float));
+                value = single;
+            }
+
+            if (timeColumn && c == 0) {
+                trajectory.time(i) = value;
+            }
+            else {
+                trajectory(i, c - (timeColumn ? 1 : 0)) = value;
+            }
+        }
+        if (!timeColumn) trajectory.time(i) = header.t0 + (double) i * header.h;
+    }
+
+    return TRAJECTORY_FILE_STATUS_OK;
+}
@@ -1,3 +1,4 @@
+#include "CsvWriter.h"
 #include "Util.h"
 
 /**
@@ -7,9 +8,43 @@
  * @return the stream.
  */
 std::ostream &operator << (std::ostream &stream, const std::vector<double> &vector) {
-    for (auto i = 0; i < vector.size() - 1; i++) {
-        stream << vector[i] << ", ";
+    return stream << std::span<const double>(vector);
+}
+
+/**
+ * Output a span of doubles (such as a row or column of a `Trajectory`) to a stream.
+ * @param stream the stream to write to.
+ * @param values the doubles to write.
+ * @return the stream.
+ */
+std::ostream &operator << (std::ostream &stream, std::span<const double> values) {
+    for (auto i = 0; i < values.size(); i++) {
+        if (i > 0) stream << ", ";
+        stream << values[i];
+    }
+    return stream;
+}
+
+/**
+ * Output a trajectory to a stream, one line of the form `t, y1, ..., yn` per time point. Values are written with the
+ * shortest round-trip formatting through a `CsvWriter`, and the stream is not flushed.
+ * @param stream the stream to write to.
+ * @param trajectory the trajectory to write.
+ * @return the stream.
+ */
+std::ostream &operator << (std::ostream &stream, const Trajectory &trajectory) {
+    CsvWriter writer(stream);
+    for (auto i = 0; i < trajectory.size(); i++) {
+        writer.value(trajectory.time(i));
+        if (trajectory.layout() == TRAJECTORY_LAYOUT_ROW_MAJOR) {
+            writer.values(trajectory.row(i));
+        }
+        else {
+            for (auto j = 0; j < trajectory.dimension(); j++) {
+                writer.value(trajectory(i, j));
+            }
+        }
+        writer.endRow();
     }
-    stream << vector[vector.size() - 1];
     return stream;
 }